@@ -26,12 +26,14 @@
 #include <filesystem>
 #include <ostream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "utils/stop_watch.h"
 
 #include "definitions.h"
 #include "config.h"
+#include "coarse_segment.h"
 #include "network.h"
 #include "segment.h"
 
@@ -82,10 +84,12 @@ int main( int argc, char* argv[] )
 
         // Create and simulate the network:
         constexpr int maxNodeDegree = 3;
+        using SegmentT =
+            std::conditional_t<mitosim::coarse_segments,
+                               mitosim::CoarseSegment<maxNodeDegree>,
+                               mitosim::Segment<maxNodeDegree>>;
         const auto network =
-            std::make_unique<
-                mitosim::Network<mitosim::Segment<maxNodeDegree>>
-                    >(cfg, *rnd, msgr);
+            std::make_unique<mitosim::Network<SegmentT>>(cfg, *rnd, msgr);
         network->assemble()->simulate();
 
         // Finalize:
@@ -0,0 +1,193 @@
+/* =============================================================================
+   Copyright (C) 2015 Valerii Sukhorukov & Michael Meyer-Hermann,
+   Helmholtz Center for Infection Research (Braunschweig, Germany).
+   All Rights Reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all
+   copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+================================================================================
+*/
+
+/**
+ * @file bench_tau_leaping.cpp
+ * @brief Speedup of the tau-leaping engine over the exact direct method.
+ * @details Simulates a number of runs of the configured network with each
+ * of the engines, and compares the wall time and the final values of the
+ * observables reported by Structure::print. The engines agree unless
+ * a permutation test of the difference of the means rejects it for any
+ * of the observables at the family-wise level of 5%, Bonferroni-corrected.
+ * The snapshots of the runs are written to the working directory.
+ * Usage: bench_tau_leaping [workingDir [configSuffix [runs]]]
+ * @author Valerii Sukhorukov
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "utils/stochastic/gillespie.h"
+
+#include "definitions.h"
+#include "config.h"
+#include "network.h"
+#include "segment.h"
+#include "simulation.h"
+#include "tau_leaping.h"
+
+namespace {
+
+using szt = mitosim::szt;
+using Network = mitosim::Network<mitosim::Segment<3>>;
+using Reaction = utils::stochastic::Reaction<mitosim::RandFactory>;
+using Exact = utils::stochastic::Gillespie<mitosim::RandFactory, Reaction>;
+using Leaping = mitosim::TauLeaping<mitosim::RandFactory, Reaction>;
+
+// The observables of Structure::print, except the conserved mass.
+const std::array<std::string,9> names {
+    "X1", "X2", "X3", "m11", "m22", "m33", "m13", "mtn", "cln"
+};
+using Observables = std::array<double,names.size()>;
+
+struct Sample {
+    std::vector<Observables> obs;
+    double seconds {};
+    szt iterations {};
+};
+
+template<typename EngineT>
+void run(
+    const mitosim::Config<mitosim::real>& cfg,
+    const unsigned seed,
+    mitosim::Msgr& msgr,
+    Sample& s
+)
+{
+    mitosim::RandFactory rnd {seed, msgr};
+    Network netw {cfg, rnd, msgr};
+    netw.assemble();
+
+    const auto start = std::chrono::steady_clock::now();
+    mitosim::Simulation<Network, EngineT> sim {
+        netw, rnd, netw.time, netw.it, msgr
+    };
+    sim.initialize()();
+    const std::chrono::duration<double> d {
+        std::chrono::steady_clock::now() - start
+    };
+
+    s.seconds += d.count();
+    s.iterations += netw.it;
+    s.obs.push_back({
+        static_cast<double>(netw.nn[0]),
+        static_cast<double>(netw.nn[1]),
+        static_cast<double>(netw.nn[2]),
+        static_cast<double>(netw.mt11.size()),
+        static_cast<double>(netw.mt22.size()),
+        static_cast<double>(netw.mt33.size()),
+        static_cast<double>(netw.mt13.size()),
+        static_cast<double>(netw.mtnum),
+        static_cast<double>(netw.clnum)
+    });
+}
+
+// Mean of an observable.
+double mean( const Sample& s, const szt k )
+{
+    double m {};
+    for (const auto& o : s.obs) m += o[k];
+
+    return m / static_cast<double>(s.obs.size());
+}
+
+// Two-sided p-value of the difference of the means of an observable,
+// from random relabelings of the pooled runs of both engines.
+double p_value( const Sample& a, const Sample& b, const szt k )
+{
+    constexpr szt permutations {9999};
+
+    std::vector<double> x;
+    for (const auto& o : a.obs) x.push_back(o[k]);
+    for (const auto& o : b.obs) x.push_back(o[k]);
+    const auto na = static_cast<long>(a.obs.size());
+    const auto nb = static_cast<long>(b.obs.size());
+    const auto diff = [&] {
+        const auto sa = std::accumulate(x.begin(), x.begin() + na, 0.);
+        const auto sb = std::accumulate(x.begin() + na, x.end(), 0.);
+        return std::abs(sa / static_cast<double>(na) -
+                        sb / static_cast<double>(nb));
+    };
+
+    const auto d = diff();
+    std::mt19937 gen {static_cast<unsigned>(k)};
+    szt n {};
+    for (szt i=0; i<permutations; i++) {
+        std::shuffle(x.begin(), x.end(), gen);
+        n += diff() >= d;
+    }
+
+    return static_cast<double>(n + 1) / static_cast<double>(permutations + 1);
+}
+
+}  // namespace
+
+
+int main( int argc, char* argv[] )
+{
+    const std::string dir    = argc > 1 ? argv[1] : "benchmarks/data";
+    const std::string suffix = argc > 2 ? argv[2] : "steady";
+    const unsigned runs      = argc > 3 ? std::stoul(argv[3]) : 30;
+
+    std::ostream null {nullptr};  // discards the simulation logs
+    mitosim::Msgr msgr {&null, &null, 6};
+    const mitosim::Config<mitosim::real> cfg {dir, suffix, "bench", msgr};
+
+    Sample exact, leaping;
+    for (unsigned i=1; i<=runs; i++) {
+        run<Exact>(cfg, i, msgr, exact);
+        run<Leaping>(cfg, runs + i, msgr, leaping);
+    }
+
+    std::cout << "mtmass " << cfg.mtmassini << " time " << cfg.timeTotal
+              << " runs " << runs << "\n";
+    std::cout << "exact   " << exact.seconds / runs << " s/run "
+              << exact.iterations / runs << " events/run\n";
+    std::cout << "leaping " << leaping.seconds / runs << " s/run "
+              << leaping.iterations / runs << " leaps or steps/run\n";
+    std::cout << "speedup " << exact.seconds / leaping.seconds << "\n";
+
+    const auto alpha = 0.05 / static_cast<double>(names.size());
+    bool agree {true};
+    for (szt k=0; k<names.size(); k++) {
+        const auto p = p_value(exact, leaping, k);
+        agree = agree && p > alpha;
+        std::cout << std::setw(4) << names[k] << " exact " << mean(exact, k)
+                  << " leaping " << mean(leaping, k) << " p " << p << "\n";
+    }
+    std::cout << (agree ? "agree" : "DISAGREE") << "\n";
+
+    return agree ? EXIT_SUCCESS : EXIT_FAILURE;
+}
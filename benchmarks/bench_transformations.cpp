@@ -0,0 +1,182 @@
+/* =============================================================================
+   Copyright (C) 2015 Valerii Sukhorukov & Michael Meyer-Hermann,
+   Helmholtz Center for Infection Research (Braunschweig, Germany).
+   All Rights Reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all
+   copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+================================================================================
+*/
+
+/**
+ * @file bench_transformations.cpp
+ * @brief Throughput of the network fission and fusion transformations.
+ * @details Drives a random sequence of fiss2, fiss3, fuse11 and fuse12
+ * events on a network of disconnected segments, bypassing the reaction
+ * propensities, and reports the time spent per event type.
+ * Usage: bench_transformations [events [segments [length [seed]]]]
+ * @author Valerii Sukhorukov
+ */
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "definitions.h"
+#include "segment.h"
+#include "ability_for_fusion.h"
+
+namespace {
+
+using Mt = mitosim::Segment<3>;
+using szt = mitosim::szt;
+
+// Subclass to make protected members accessible.
+class Transformer
+    : public mitosim::AbilityForFusion<Mt> {
+
+public:
+
+    using AbilityForFusion<Mt>::clnum;
+    using AbilityForFusion<Mt>::fiss2;
+    using AbilityForFusion<Mt>::glm;
+    using AbilityForFusion<Mt>::mt;
+    using AbilityForFusion<Mt>::mtnum;
+    using AbilityForFusion<Mt>::update_structure;
+
+    explicit Transformer(mitosim::Msgr& msgr)
+        : AbilityForFusion<Mt> {msgr}
+    {}
+};
+
+enum Event { Fis2, Fis3, Fu11, Fu12, numEvents };
+
+const std::array<std::string,numEvents> names {
+    "fiss2", "fiss3", "fuse11", "fuse12"
+};
+
+// Relative event frequencies keeping a branched steady state.
+const std::array<double,numEvents> weights {1., 1., 1., 1.};
+
+}  // namespace
+
+
+int main( int argc, char* argv[] )
+{
+    const szt events   = argc > 1 ? std::stoul(argv[1]) : 200'000;
+    const szt segments = argc > 2 ? std::stoul(argv[2]) : 1'000;
+    const szt length   = argc > 3 ? std::stoul(argv[3]) : 20;
+    const auto seed    = argc > 4 ? std::stoul(argv[4]) : 1UL;
+
+    mitosim::Msgr msgr {nullptr, nullptr, 6};
+    Transformer t {msgr};
+    for (szt i=0; i<segments; i++)
+        t.add_disconnected_segment(length);
+    t.update_structure();
+
+    std::mt19937_64 rng {seed};
+    auto pick = [&](const szt n) {
+        return std::uniform_int_distribution<szt> {0, n - 1}(rng);
+    };
+
+    // A random node of degree 1.
+    auto free_end = [&](szt& w, szt& e) {
+        const auto n11 = 2 * t.mt11.size();
+        if (!n11 && t.mt13.empty()) return false;
+        const auto k = pick(n11 + t.mt13.size());
+        if (k < n11) {
+            w = t.mt11[k / 2];
+            e = k % 2 + 1;
+        }
+        else {
+            w = t.mt13[k - n11][0];
+            e = t.mt13[k - n11][1];
+        }
+        return true;
+    };
+    std::discrete_distribution<int> event {weights.begin(), weights.end()};
+
+    // Position of a node of degree 2, if the edge chosen has one.
+    auto inner = [&](szt& w, szt& a) {
+        const auto ind = pick(t.mtmass);
+        w = t.glm[ind];
+        a = t.mt[w].pos(t.gla[ind]);
+        return a > 0;
+    };
+
+    std::array<szt,numEvents> count {};
+    std::array<double,numEvents> time {};
+
+    for (szt i=0; i<events; i++) {
+        const auto ev = static_cast<Event>(event(rng));
+        szt w1 {}, w2 {}, e1 {}, e2 {}, a {};
+        const auto start = std::chrono::steady_clock::now();
+        switch (ev) {
+            case Fis2:
+                if (!inner(w1, a)) continue;
+                t.fiss2(w1, a);
+                break;
+            case Fis3: {
+                if (t.mt13.empty()) continue;
+                const auto [w, e] = t.mt13[pick(t.mt13.size())];
+                t.fiss3(w, e == 1 ? 2 : 1);
+                break;
+            }
+            case Fu11:
+                if (!free_end(w1, e1) || !free_end(w2, e2) || w1 == w2)
+                    continue;
+                t.fuse11(w1, e1, w2, e2);
+                t.update_structure();
+                break;
+            case Fu12:
+                if (!free_end(w1, e1) || !inner(w2, a)) continue;
+                t.fuse12(w1, e1, w2, a);
+                t.update_structure();
+                break;
+            default:
+                break;
+        }
+        t.touched.clear();
+        const std::chrono::duration<double> d {
+            std::chrono::steady_clock::now() - start
+        };
+        time[ev] += d.count();
+        count[ev]++;
+    }
+
+    std::cout << "sizeof(Segment<3>) " << sizeof(Mt) << " B\n";
+    std::cout << "segments " << t.mtnum << " clusters " << t.clnum
+              << " edges " << t.mtmass << " m11 " << t.mt11.size()
+              << " m13 " << t.mt13.size() << " m33 " << t.mt33.size() << "\n";
+    szt total {};
+    double ttotal {};
+    for (int e=0; e<numEvents; e++) {
+        std::cout << names[e] << " " << count[e] << " events "
+                  << (count[e] ? 1e9 * time[e] / count[e] : 0.)
+                  << " ns/event\n";
+        total += count[e];
+        ttotal += time[e];
+    }
+    std::cout << "total " << total << " events "
+              << (ttotal > 0. ? total / ttotal : 0.) << " events/s\n";
+
+    return EXIT_SUCCESS;
+}
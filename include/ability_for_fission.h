@@ -33,6 +33,8 @@
 #define MITOSIM_ABILITY_FOR_FISSION_H
 
 #include <algorithm>
+#include <array>
+#include <utility>
 #include <vector>
 
 #include "core_transformer.h"
@@ -48,27 +50,35 @@ template<typename> class Fission;
  * and updates the network for it.
  * @tparam Mt Type of the Edge forming the network.
  */
-template<typename Mt>
+template<typename Mt, typename Ind=Index>
 class AbilityForFission
-    : public CoreTransformer<Mt> {
+    : public CoreTransformer<Mt, Ind> {
 
-    using thisT = AbilityForFission<Mt>;
+    using thisT = AbilityForFission<Mt, Ind>;
     using ThisFission = Fission<thisT>;
 
 protected:
 
-    using Structure<Mt>::msgr;
-    using Structure<Mt>::mt;
-    using Structure<Mt>::mtnum;
-    using Structure<Mt>::clnum;
-    using Structure<Mt>::glm;
-    using CoreTransformer<Mt>::copy_neigs;
-    using CoreTransformer<Mt>::update_neigs;
-    using CoreTransformer<Mt>::fuse_antiparallel;
-    using CoreTransformer<Mt>::fuse_parallel;
-    using CoreTransformer<Mt>::update_gIndcl;
-
-    using Structure<Mt>::update_structure;
+    using Structure<Mt, Ind>::msgr;
+    using Structure<Mt, Ind>::mt;
+    using Structure<Mt, Ind>::mtnum;
+    using Structure<Mt, Ind>::handles;
+    using Structure<Mt, Ind>::clnum;
+    using Structure<Mt, Ind>::glm;
+    using Structure<Mt, Ind>::touch;
+    using Structure<Mt, Ind>::add_to_cluster;
+    using Structure<Mt, Ind>::remove_from_cluster;
+    using Structure<Mt, Ind>::recluster;
+    using Structure<Mt, Ind>::map_edges;
+    using Structure<Mt, Ind>::push_segment;
+    using Structure<Mt, Ind>::reserve_g;
+    using CoreTransformer<Mt, Ind>::copy_neigs;
+    using CoreTransformer<Mt, Ind>::update_neigs;
+    using CoreTransformer<Mt, Ind>::fuse_antiparallel;
+    using CoreTransformer<Mt, Ind>::fuse_parallel;
+    using CoreTransformer<Mt, Ind>::update_gIndcl;
+
+    using Structure<Mt, Ind>::update_structure;
 
 public:
 
@@ -101,11 +111,19 @@ public:
 
 private:
 
-    /// Auxiliary, indicating visited status of segments during the graph search.
-    std::vector<szt>  vis {};
+    /// Auxiliary, visit stamps of segments during the graph search.
+    std::vector<szt> vis {};
+    /// Current stamp: 'vis' values below it are left by earlier searches.
+    szt stamp {};
+    /// Auxiliary, search stacks of {segment, end} pairs for either side.
+    std::array<std::vector<std::array<szt,2>>,2> front {};
+    /// Auxiliary, segments reached from either side during the graph search.
+    std::array<std::vector<szt>,2> side {};
 
     /**
      * @brief Update network component for changes resulting from its division.
+     * @details If the components get disconnected, the smaller one, as found
+     * by connected_around(), is moved to a new cluster.
      * @return A flag indicating if the division produces a pair
      * of disconnected components.
      * @param w Segment index.
@@ -114,90 +132,119 @@ private:
     bool update_cl_fiss(szt w, szt e) noexcept;
 
     /**
-     * @brief Depth-first search of the network graph.
-     * @param w1 Initial segment index.
-     * @param e1 Initial segment end.
-     * @param w2 Final segment index.
-     * @param e2 Final segment end.
-     * @return True if there is a connection between {w1,e1} and {w2,e2}.
+     * @brief Check if the segment ends are connected bypassing the segment.
+     * @details Two iterative searches proceed in turns from the nodes at the
+     * segment ends, so that the connection, if any, is found when the fronts
+     * meet. Otherwise, the search stops as soon as either side is explored
+     * completely, which bounds it by the smaller side. The segments of that
+     * side, including 'w' if it is the side opposite to 'e', are left
+     * in side[0].
+     * @param w Segment index.
+     * @param e Segment end.
+     * @return True if there is a connection between the ends of 'w'.
      */
-    bool dfs(szt w1, szt e1, szt w2, szt e2);
+    bool connected_around(szt w, szt e);
 };
 
 
 // IMPLEMENTATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-template<typename Mt>
-AbilityForFission<Mt>::
+template<typename Mt, typename Ind>
+AbilityForFission<Mt, Ind>::
 AbilityForFission(Msgr& msgr)
-    : CoreTransformer<Mt> {msgr}
+    : CoreTransformer<Mt, Ind> {msgr}
 {}
 
 
-template<typename Mt>
-bool AbilityForFission<Mt>::
+template<typename Mt, typename Ind>
+bool AbilityForFission<Mt, Ind>::
 update_cl_fiss( const szt w,
                 const szt e ) noexcept
 {
-    vis.resize(mtnum + 2);
-    // Nothing is visited in the beginning of the search.
-    std::fill(vis.begin() + 1,
-              vis.begin() + static_cast<long>(mtnum) + 1,
-              0);
-
-    const auto oe = e == 1 ? 2UL : 1UL;
-
-    const bool is_cycle = dfs(w, e, w, oe);
+    const bool is_cycle = connected_around(w, e);
     if (!is_cycle) {
         clnum++;
+        // Keep Edge::indcl ordered by segment index.
+        if constexpr (!lazy_edge_cl)
+            std::sort(side[0].begin(), side[0].end());
         szt clind {};
-        for (szt i=1; i<=mtnum; i++)
-            if (vis[i])
-                clind = mt[i].setCl(clnum - 1, clind);
+        for (const auto i : side[0]) {
+            remove_from_cluster(i);
+            clind = mt[i].setCl(clnum - 1, clind);
+            add_to_cluster(i);
+            recluster(i);
+        }
     }
     return is_cycle;
 }
 
 
-template<typename Mt>
-bool AbilityForFission<Mt>::
-dfs( const szt w1, const szt e1,
-     const szt w2, const szt e2 )
+template<typename Mt, typename Ind>
+bool AbilityForFission<Mt, Ind>::
+connected_around( const szt w,
+                  const szt e )
 {
-    for (szt i=1; i<=mt[w1].nn[e1]; i++) {
-        const auto cn = mt[w1].neig[e1][i];
-        const auto ce = mt[w1].neen[e1][i];
-        if (cn == w2) {
-            if (ce == e2)
+    vis.resize(mt.size());
+    stamp += 2;                         // stamp: side of e; stamp+1: the other
+
+    const std::array<szt,2> ends {e, e == 1 ? 2UL : 1UL};
+    for (szt k=0; k<2; k++) {
+        front[k].clear();
+        front[k].push_back({w, ends[k]});
+    }
+    side[0].clear();
+    side[1].clear();
+
+    // Expands one node of side k; returns true if the sides are found to meet.
+    const auto step = [&](const szt k) {
+        const auto [w1, e1] = front[k].back();
+        front[k].pop_back();
+        for (szt i=1; i<=mt[w1].nn[e1]; i++) {
+            const auto cn = mt[w1].neig[e1][i];
+            const auto ce = mt[w1].neen[e1][i];
+            if (cn == w) {
+                if (ce == ends[1-k])
+                    return true;
+            }
+            else if (vis[cn] == stamp + 1 - k)
                 return true;
+            else if (vis[cn] != stamp + k) {
+                vis[cn] = stamp + k;
+                side[k].push_back(cn);
+                front[k].push_back({cn, ce == 1 ? 2UL : 1UL});
+            }
         }
-        else {
-            if (!vis[cn]) {
-                vis[cn] = 1;
-                const auto ne = ce == 1 ? 2UL : 1UL;
-                if (dfs(cn, ne, w2, e2))
-                    return true;
+        return false;
+    };
+
+    for (szt k=0; ; k=1-k) {
+        if (step(k))
+            return true;
+        if (front[k].empty()) {
+            if (k) {
+                side[1].push_back(w);
+                std::swap(side[0], side[1]);
             }
-        }    
+            return false;
+        }
     }
-    return false;
 }
 
 
 // 'a' is counted from 1 and is the last element to remain in the old segment.
-template<typename Mt>
-auto AbilityForFission<Mt>::
+template<typename Mt, typename Ind>
+auto AbilityForFission<Mt, Ind>::
 fiss( const szt w,
       const szt a ) -> std::array<szt,2>
 {
     // node 2 -> nodes 1+1; cuts between g[a-1] and g[a]
-    if (a && a < mt[w].g.size())
+    if (a && a < mt[w].length())
         return fiss2(w, a);
 
     // node 3 -> nodes 2+1 and node 2 -> nodes 1+1 in pure loops
     if (!a && mt[w].nn[1] <= 2)
         return fiss3(w, 1);
-    if (a == mt[w].g.size() && mt[w].nn[2] <= 2)
+    if (a == mt[w].length() && mt[w].nn[2] <= 2)
         return fiss3(w, 2);
 
     msgr.exit("ERROR: Attempt of an unpropriate fission!");
@@ -210,45 +257,57 @@ fiss( const szt w,
 // 'w' is a global segment index
 // 'a' is the node position inside the segment 'w'
 // 'a' is counted from 1 and is the last element to remain in the original segment
-template<typename Mt>
-auto AbilityForFission<Mt>::
+template<typename Mt, typename Ind>
+auto AbilityForFission<Mt, Ind>::
 fiss2( const szt w,
        const szt a ) -> std::array<szt,2>
 {
     if constexpr (verbose)
         mt[w].print(w, "fission2:  ", a);     // cuts between g[a-1] and g[a]
 
-    XASSERT(a && a < mt[w].g.size(), "Error: fiss2 at the segment border.");
+    XASSERT(a && a < mt[w].length(), "Error: fiss2 at the segment border.");
 
-    [[maybe_unused]] const auto clini = mt[w].get_cl();
+    const auto clini = mt[w].get_cl();
 
-    const auto ind1 = mt[w].g[a-1].get_ind();
-    const auto ind2 = mt[w].g[a].get_ind();
+    // Edges at the cut, followed through the transformation.
+    [[maybe_unused]] auto ind1 = undefined<szt>;
+    [[maybe_unused]] auto ind2 = undefined<szt>;
+    if constexpr (!Mt::coarse) {
+        ind1 = mt[w].edge(a-1).get_ind();
+        ind2 = mt[w].edge(a).get_ind();
+    }
 
     bool inCycle {};
     mt[w].nn[2] ? (inCycle = update_cl_fiss(w, 2))
                 : clnum++;
 
-    mt.emplace_back(msgr);
+    push_segment();
     ++mtnum;
-
-    std::move(mt[w].g.begin() + static_cast<long>(a),
-              mt[w].g.end(),
-              std::back_inserter(mt[mtnum].g));
-    mt[w].g.erase(mt[w].g.begin() + static_cast<long>(a),
-                  mt[w].g.end());
+    handles.insert(mtnum);
+    touch(w);
+    touch(mtnum);
+
+    // A reflected segment keeps the head of its storage in the new one.
+    const auto remap = mt[w].is_reversed();
+    reserve_g(mtnum, mt[w].length());
+    mt[w].split_g(a, mt[mtnum]);
+    if (remap)
+        map_edges(w);
+    map_edges(mtnum);
 
     mt[mtnum].nn[1] = 0;
 
     this->copy_neigs(w, 2, mtnum, 2);
 
-    mt[mtnum].set_cl(inCycle
-                     ? mt[w].get_cl()
+    // Either side of the cut may have moved to the new cluster.
+    mt[mtnum].set_cl(inCycle || mt[w].get_cl() != clini
+                     ? clini
                      : clnum - 1);
+    add_to_cluster(mtnum);
 
     if (!inCycle) {
         // Renumber Edge::indcl of the remaining part of the original cluster.
-        update_gIndcl(mt[w].get_cl());
+        update_gIndcl(clini);
         // Renumber Edge::indcl of the newly formed cluster.
         update_gIndcl(clnum-1);
     }
@@ -272,19 +331,22 @@ fiss2( const szt w,
     }
 
     update_structure();
-    const auto w1 = glm[ind1];
-    const auto w2 = glm[ind2];
 
-    XASSERT(mt[w1].get_cl() == clini ||
-            mt[w2].get_cl() == clini,
-            "Error in fiss2: mt[w1].cl != clini && mt[w2].cl != clini\n");
+    if constexpr (!Mt::coarse) {
+        const auto w1 = glm[ind1];
+        const auto w2 = glm[ind2];
 
-    if constexpr (verbose) {
-        mt[w1].print(w1, "producing ");
-        if (isSelfLooped)
-            msgr.print("from a segment looped into itself");
-        else mt[w2].print(w2, "      and ");
-        std::cout << std::endl;
+        XASSERT(mt[w1].get_cl() == clini ||
+                mt[w2].get_cl() == clini,
+                "Error in fiss2: mt[w1].cl != clini && mt[w2].cl != clini\n");
+
+        if constexpr (verbose) {
+            mt[w1].print(w1, "producing ");
+            if (isSelfLooped)
+                msgr.print("from a segment looped into itself");
+            else mt[w2].print(w2, "      and ");
+            std::cout << std::endl;
+        }
     }
 
     return {mt[w].get_cl(), mt[mtnum].get_cl()};
@@ -294,8 +356,8 @@ fiss2( const szt w,
 // 'w' is a global segment index
 // 'at' is the node position inside the segment 'w'
 // 'at' is counted from 1 and is the last element to remain in the original segment
-template<typename Mt>
-auto AbilityForFission<Mt>::
+template<typename Mt, typename Ind>
+auto AbilityForFission<Mt, Ind>::
 fiss3( const szt w,
        const szt end ) -> std::array<szt,2>
 {
@@ -304,16 +366,19 @@ fiss3( const szt w,
 
     const auto clini = mt[w].get_cl();
     bool f {};
+    bool inCycle {};
     std::array<szt,2> n;
     std::array<szt,2> e;
-    auto ind1 = undefined<szt>;
-    auto ind2 = undefined<szt>;
+    [[maybe_unused]] auto ind1 = undefined<szt>;
+    [[maybe_unused]] auto ind2 = undefined<szt>;
 
     if (end == 1) {
-        ind1 = mt[w].g.front().get_ind();
-        ind2 = mt[mt[w].neig[1][1]]
-                .g[mt[mt[w].neig[1][1]].end2a(mt[w].neen[1][1])]
-                .get_ind();
+        if constexpr (!Mt::coarse) {
+            ind1 = mt[w].edge(0).get_ind();
+            ind2 = mt[mt[w].neig[1][1]]
+                    .g[mt[mt[w].neig[1][1]].end2a(mt[w].neen[1][1])]
+                    .get_ind();
+        }
 
         if (mt[w].nn[1] == 2) {
             const auto ninds = mt[w].double_neig_indexes(1);
@@ -326,9 +391,9 @@ fiss3( const szt w,
         else if (mt[w].nn[1] == 1)
             n[0] = mt[w].neig[1][1];
 
-        // If not a cycle, this increments clnum and forms a new cluster
-        // from w's end 1 neigs and beyond (excluding w itself).
-        const auto inCycle = update_cl_fiss(w, 1);
+        // If not a cycle, this increments clnum and moves the smaller side,
+        // w's end 1 neigs and beyond or w with the rest, to a new cluster.
+        inCycle = update_cl_fiss(w, 1);
         if (!inCycle)
             // Renumber Edge::indcl of the remaining part of the original cluster.
             update_gIndcl(clini);
@@ -380,10 +445,12 @@ fiss3( const szt w,
         }
     }
     else if (end == 2) {
-        ind1 = mt[w].g.back().get_ind();
-        ind2 = mt[mt[w].neig[2][1]]
-                .g[mt[mt[w].neig[2][1]].end2a(mt[w].neen[2][1])]
-                .get_ind();
+        if constexpr (!Mt::coarse) {
+            ind1 = mt[w].edge(mt[w].length()-1).get_ind();
+            ind2 = mt[mt[w].neig[2][1]]
+                    .g[mt[mt[w].neig[2][1]].end2a(mt[w].neen[2][1])]
+                    .get_ind();
+        }
         if (mt[w].nn[2] == 2) {
             const auto ninds = mt[w].double_neig_indexes(2);
             f = true;
@@ -395,9 +462,9 @@ fiss3( const szt w,
         else if (mt[w].nn[2] == 1)
             n[0] = mt[w].neig[2][1];
 
-        // If not a cycle, this increments clnum and forms a new cluster
-        // from w's end 2 neigs and beyond (excluding w itself).
-        const auto inCycle = update_cl_fiss(w, 2);
+        // If not a cycle, this increments clnum and moves the smaller side,
+        // w's end 2 neigs and beyond or w with the rest, to a new cluster.
+        inCycle = update_cl_fiss(w, 2);
         if (!inCycle)
             // Renumber Edge::indcl of the remaining part of the original cluster.
             update_gIndcl(clini);
@@ -447,6 +514,11 @@ fiss3( const szt w,
 
     update_structure();
 
+    // Without the edges to follow, the clusters are known from the split:
+    // the original one and, unless in a cycle, the last one.
+    if constexpr (Mt::coarse)
+        return {clini, inCycle ? clini : clnum - 1};
+
     const auto w1 = glm[ind1];
     const auto w2 = glm[ind2];
     XASSERT(mt[w1].get_cl() == clini ||
@@ -48,20 +48,22 @@ namespace mitosim {
  * for it. Forms base for clases adding more specific tapes of dynamics.
  * @tparam Mt Type of the Edge forming the network.
  */
-template<typename Mt>
+template<typename Mt, typename Ind=Index>
 class AbilityForFusion
-    : public AbilityForFission<Mt> {
+    : public AbilityForFission<Mt, Ind> {
 
 protected:
 
-    using Structure<Mt>::mt;
-    using Structure<Mt>::mtnum;
-    using Structure<Mt>::msgr;
-    using CoreTransformer<Mt>::update_cl_fuse;
-    using CoreTransformer<Mt>::fuse_antiparallel;
-    using CoreTransformer<Mt>::fuse_parallel;
-    using CoreTransformer<Mt>::fuse_to_loop;
-    using AbilityForFission<Mt>::fiss2;
+    using Structure<Mt, Ind>::mt;
+    using Structure<Mt, Ind>::mtnum;
+    using Structure<Mt, Ind>::msgr;
+    using Structure<Mt, Ind>::junctions;
+    using Structure<Mt, Ind>::touch;
+    using CoreTransformer<Mt, Ind>::update_cl_fuse;
+    using CoreTransformer<Mt, Ind>::fuse_antiparallel;
+    using CoreTransformer<Mt, Ind>::fuse_parallel;
+    using CoreTransformer<Mt, Ind>::fuse_to_loop;
+    using AbilityForFission<Mt, Ind>::fiss2;
 
 public:
 
@@ -106,15 +108,15 @@ public:
 
 // IMPLEMENTATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-template<typename Mt>
-AbilityForFusion<Mt>::
+template<typename Mt, typename Ind>
+AbilityForFusion<Mt, Ind>::
 AbilityForFusion(Msgr& msgr)
-    : AbilityForFission<Mt> {msgr}
+    : AbilityForFission<Mt, Ind> {msgr}
 {}
 
 
-template<typename Mt>
-auto AbilityForFusion<Mt>::
+template<typename Mt, typename Ind>
+auto AbilityForFusion<Mt, Ind>::
 fuse11(
     const szt w1,
     const szt e1,
@@ -129,8 +131,8 @@ fuse11(
 }
 
 
-template<typename Mt>
-auto AbilityForFusion<Mt>::
+template<typename Mt, typename Ind>
+auto AbilityForFusion<Mt, Ind>::
 fuse12(
     const szt w1,
     const szt end,
@@ -140,13 +142,13 @@ fuse12(
 {
     if constexpr (verbose) {
         msgr.print("Fusion12:  ",
-                   w1, "(of ", mt[w1].g.size(), " e ", end, ") with ",
-                   w2, "(of ", mt[w2].g.size(), " at ", a2, ")\n");
+                   w1, "(of ", mt[w1].length(), " e ", end, ") with ",
+                   w2, "(of ", mt[w2].length(), " at ", a2, ")\n");
         mt[w1].print(w1, "before s: ");
         mt[w2].print(w2, "before s: ");
     }
 
-    XASSERT(a2 && a2 < mt[w2].g.size(), "fuse12 at the very end of w2");
+    XASSERT(a2 && a2 < mt[w2].length(), "fuse12 at the very end of w2");
 
     const auto cl1 = mt[w1].get_cl();
     const auto cl2 = mt[w2].get_cl();
@@ -171,6 +173,8 @@ fuse12(
             mt[mi].nn[1] = 2;
             mt[mi].neig[1][1] = w1;        mt[mi].neen[1][1] = 1;
             mt[mi].neig[1][2] = w1;        mt[mi].neen[1][2] = 2;
+
+            junctions.attach(junctions.join(w1, 1, w1, 2), mi, 1);
         }
         else {
             mt[w1].nn[2] = 2;
@@ -184,6 +188,8 @@ fuse12(
             mt[mi].nn[2] = 2;
             mt[mi].neig[2][1] = w1;        mt[mi].neen[2][1] = 2;
             mt[mi].neig[2][2] = mi;        mt[mi].neen[2][2] = 1;
+
+            junctions.attach(junctions.join(w1, 2, mi, 1), mi, 2);
         }
     }
     else {
@@ -198,8 +204,17 @@ fuse12(
         mt[mi].nn[1] = 2;
         mt[mi].neig[1][1] = w1;            mt[mi].neen[1][1] = end;
         mt[mi].neig[1][2] = w2;            mt[mi].neen[1][2] = 2;
-    }
 
+        junctions.attach(junctions.join(w1, end, w2, 2), mi, 1);
+    }
+    // After fiss2(), which has already updated the structure.
+    touch(w1);
+    touch(w2);
+    touch(mi);
+
+    // A component split off by fiss2() is the last one, so it is merged
+    // back into 'cl2'. The indexes affected are then 'cl1' and 'cl2':
+    // the merged component and the one released.
     if (mt[w2].get_cl() != mt[mi].get_cl())
         update_cl_fuse(mt[w2].get_cl(), mt[mi].get_cl());
     if (mt[w2].get_cl() != mt[w1].get_cl())
@@ -213,12 +228,12 @@ fuse12(
             mt[mi].print(mi, "     and ");
         msgr.print("\n");
     }
-    return {cl1, cl2};
+    return {mt[w1].get_cl(), mt[w1].get_cl() == cl1 ? cl2 : cl1};
 }
 
 
-template<typename Mt>
-auto AbilityForFusion<Mt>::
+template<typename Mt, typename Ind>
+auto AbilityForFusion<Mt, Ind>::
 fuse1L(
     const szt w1,
     const szt e1,
@@ -227,14 +242,17 @@ fuse1L(
 {
     if constexpr (verbose) {
         msgr.print("Fusion1U:  ",
-                   w1, "(of ", mt[w1].g.size(), " e ", e1,
-                   ") with a CYCLE ", w2, "(of ", mt[w2].g.size(), ")\n");
+                   w1, "(of ", mt[w1].length(), " e ", e1,
+                   ") with a CYCLE ", w2, "(of ", mt[w2].length(), ")\n");
         mt[w1].print(w1, "before s: ");
         mt[w2].print(w2, "before s: ");
     }
     const auto cl1 = mt[w1].get_cl();
     const auto cl2 = mt[w2].get_cl();
 
+    touch(w1);
+    touch(w2);
+
     // update w1 at e1
     mt[w1].nn[e1] = 2;
     mt[w1].neig[e1][1] = w2;    mt[w1].neen[e1][1] = 1;
@@ -250,6 +268,9 @@ fuse1L(
     mt[w2].neig[2][1] = w2;        mt[w2].neen[2][1] = 1;
     mt[w2].neig[2][2] = w1;        mt[w2].neen[2][2] = e1;
 
+    // The cycle node of w2 becomes a junction.
+    junctions.attach(junctions.at(w2, 1), w1, e1);
+
     if (mt[w1].get_cl() != mt[w2].get_cl() )
         update_cl_fuse(mt[w1].get_cl(), mt[w2].get_cl());
 
@@ -258,7 +279,7 @@ fuse1L(
         mt[w2].print(w2, "      and ");
         msgr.print("\n");
     }
-    return {cl1, cl2};
+    return {mt[w1].get_cl(), mt[w1].get_cl() == cl1 ? cl2 : cl1};
 }
 
 
@@ -0,0 +1,362 @@
+/* =============================================================================
+   Copyright (C) 2015 Valerii Sukhorukov & Michael Meyer-Hermann,
+   Helmholtz Center for Infection Research (Braunschweig, Germany).
+   All Rights Reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all
+   copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+================================================================================
+*/
+
+/**
+ * @file coarse_segment.h
+ * @brief Contains CoarseSegment class template and its specialization.
+ * @details Only graphs of max degree 3 are considered.
+ * @author Valerii Sukhorukov
+ */
+
+#ifndef MITOSIM_COARSE_SEGMENT_H
+#define MITOSIM_COARSE_SEGMENT_H
+
+#include <fstream>
+#include <ostream>
+#include <string>
+
+#include "definitions.h"
+#include "segment_ends.h"
+
+namespace mitosim {
+
+/**
+ * @brief Class template for the Network Segments without edge storage.
+ * @details A drop-in replacement of Segment for networks, in which the
+ * individual edges carry no data: the segment is reduced to its length
+ * and end topology. Fission positions are plain offsets along the segment,
+ * and fusion adds the lengths, so that neither depends on the length.
+ * @tparam _ Max node degree that the graph is able to handle.
+ */
+template<unsigned _>
+class CoarseSegment {};
+
+/**
+ * @brief CoarseSegment class specification for max node degree equal to 3.
+ * @details Requires the homogeneous fission: there are no edge end factors.
+ */
+template<>
+class CoarseSegment<3>
+    : public SegmentEnds<3> {
+
+public:
+
+    /// The edges are represented by their number only.
+    static constexpr bool coarse {true};
+
+    using thisT = CoarseSegment<maxDegree>;
+    using FinT = real;  ///< Contribution to fission propensity.
+
+    /// Nothing to recycle: a coarse segment owns no storage.
+    struct Store {};
+
+    /**
+     * @brief Constructor
+     * @param msgr Output message processor.
+     */
+    explicit CoarseSegment(Msgr& msgr);
+
+    /**
+     * @brief Constructor.
+     * @param cl Index of subnetwork to which the sebment belongs.
+     * @param msgr Output message processor.
+     */
+    explicit CoarseSegment(Msgr& msgr,
+                           szt cl);
+
+    /**
+     * @brief Constructor.
+     * @param segmass Segment mass.
+     * @param cl Index of subnetwork to which the sebment belongs.
+     * @param ei Index of the last edge in this segment (unused).
+     * @param msgr Output message processor.
+     */
+    explicit CoarseSegment(
+        szt segmass,
+        szt cl,
+        szt ei,
+        Msgr& msgr );
+
+    constexpr auto get_cl() const noexcept { return cl; }
+    void set_cl( szt newcl ) noexcept { cl = newcl; }
+
+    /// Reflect the segment: nothing to reorder.
+    constexpr void reflect_g() noexcept {}
+
+    /// A coarse segment has no storage order to report.
+    constexpr auto is_reversed() const noexcept -> bool { return false; }
+
+    /// Nothing to reorder.
+    constexpr void orient() noexcept {}
+
+    /**
+     * @brief Take over the length of another segment.
+     * @param o The segment giving away the edges.
+     */
+    constexpr void take_g(thisT& o) noexcept;
+
+    /// Nothing to give away.
+    constexpr auto release_g() noexcept -> Store { len = 0; return {}; }
+
+    /// Nothing to adopt.
+    constexpr void adopt_g(Store&&) noexcept {}
+
+    /// Nothing to make room for.
+    constexpr void reserve_g(szt) noexcept {}
+
+    /**
+     * @brief Move the edges past an in-segment position to another segment.
+     * @param a In-segment position of the first edge moved.
+     * @param o The segment receiving the edges.
+     */
+    constexpr void split_g(szt a, thisT& o) noexcept;
+
+    /**
+     * @brief Append the edges of another segment to this one.
+     * @param o The segment giving away the edges.
+     */
+    constexpr void append_g(thisT& o) noexcept;
+
+    /**
+     * @brief Change cluster index keeping the segment index unoltered.
+     * @param newcl New disconnected component index (unused).
+     * @param initind Starting edge index in the current disconnected component.
+     * @return The last edge index in the current disconnected network component.
+     */
+    constexpr auto set_gCl(szt newcl, szt initind) const noexcept -> szt;
+
+    /**
+     * @brief Changecluster index.
+     * @param newcl New disconnected component index.
+     * @param initind Starting edge index in the current disconnected component.
+     * @return The last edge index in the current disconnected network component.
+     */
+    constexpr auto setCl(szt newcl, szt initind) noexcept -> szt;
+
+    /**
+     * @brief Report the number of nodes of a given degree.
+     * @param deg Node degree.
+     * @return the Number of nodes.
+     */
+    constexpr auto num_nodes(szt deg) const noexcept -> szt;
+
+    /**
+     * @brief Report the segment length measured in edges.
+     * @return the Segment length measured in edges.
+     */
+    constexpr auto length() const noexcept -> szt { return len; }
+
+    /// Print segment parameters.
+    void print(
+        szt w,
+        const std::string& tag,
+        szt at=undefined<szt>
+    ) const;
+
+    /// Print segment parameters.
+    void print(
+        std::ostream& os,
+        szt w,
+        const std::string& tag,
+        szt at=undefined<szt>
+    ) const;
+
+    /**
+     * @brief Write the segment to a binary file.
+     * @details Same layout as for Segment, but without the edges.
+     * @param ofs std::ofstream to write to.
+     * @param initind Cluster-wide index of the first edge (unused).
+     */
+    void write(std::ofstream& ofs, szt initind) const;
+
+    /**
+     * @brief Read the segment from a binary file written by write().
+     * @param ifs std::ifstream to read from.
+     */
+    void read(std::ifstream& ifs);
+
+protected:
+
+    szt len {};  ///< Segment length measured in edges.
+    szt cl {};   ///< cluster index.
+
+    Msgr& msgr;  ///< Output message processor.
+};
+
+// IMPLEMENTATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+inline
+CoarseSegment<3>::
+CoarseSegment(Msgr& msgr)
+    : msgr {msgr}
+{}
+
+inline
+CoarseSegment<3>::
+CoarseSegment(
+    Msgr& msgr,
+    const szt cl
+)
+    : cl {cl}
+    , msgr {msgr}
+{}
+
+inline
+CoarseSegment<3>::
+CoarseSegment(
+      const szt segmass,
+      const szt cl,
+      [[maybe_unused]] szt ei,
+      Msgr& msgr     // var ref
+)
+    : len {segmass}
+    , cl {cl}
+    , msgr {msgr}
+{}
+
+
+constexpr
+void CoarseSegment<3>::
+take_g( thisT& o ) noexcept
+{
+    len = o.len;
+    o.len = 0;
+}
+
+
+constexpr
+void CoarseSegment<3>::
+split_g(
+    const szt a,
+    thisT& o
+) noexcept
+{
+    XASSERT(a <= len, "Error in CoarseSegment::split_g: a > len");
+
+    o.len = len - a;
+    len = a;
+}
+
+
+constexpr
+void CoarseSegment<3>::
+append_g( thisT& o ) noexcept
+{
+    len += o.len;
+    o.len = 0;
+}
+
+
+constexpr
+auto CoarseSegment<3>::
+set_gCl(
+    [[maybe_unused]] const szt newcl,
+    const szt initind
+) const noexcept -> szt
+{
+    return initind + len;
+}
+
+
+constexpr
+auto CoarseSegment<3>::
+setCl(
+    const szt newcl,
+    const szt initind
+) noexcept -> szt
+{
+    cl = newcl;
+    return set_gCl(newcl, initind);
+}
+
+
+constexpr
+auto CoarseSegment<3>::
+num_nodes( const szt deg ) const noexcept -> szt // deg = 1, 2, 3
+{
+    const auto n = count_nodes(deg, len);
+    if (is_defined(n))
+        return n;
+
+    msgr.exit("Error in CoarseSegment::num_nodes(). Not implemented for degree ",
+              deg);
+    return undefined<szt>;
+}
+
+
+inline
+void CoarseSegment<3>::
+print( const szt w,
+       const std::string& tag,
+       const szt at ) const
+{
+    if (msgr.so) print(*msgr.so, w, tag, at);
+    if (msgr.sl) print(*msgr.sl, w, tag, at);
+}
+
+
+inline
+void CoarseSegment<3>::
+print( std::ostream& os,
+       const szt w,
+       const std::string& tag,
+       const szt at) const
+{
+    os << "        " << tag << w;
+    if (is_defined(at))
+        os << "(of ";
+    else
+        os << "(at " << at << " of ";
+    os << len << ") ";
+    print_ends(os);
+    os << cl << " len " << len << std::endl;
+}
+
+
+inline
+void CoarseSegment<3>::
+write(
+    std::ofstream& ofs,
+    [[maybe_unused]] const szt initind
+) const
+{
+    ofs.write(reinterpret_cast<const char*>(&len), sizeof(szt));
+    ofs.write(reinterpret_cast<const char*>(&cl), sizeof(szt));
+    write_ends(ofs);
+}
+
+
+inline
+void CoarseSegment<3>::
+read( std::ifstream& ifs )
+{
+    ifs.read(reinterpret_cast<char*>(&len), sizeof(szt));
+    ifs.read(reinterpret_cast<char*>(&cl), sizeof(szt));
+    read_ends(ifs);
+}
+
+}  // namespace mitosim
+
+#endif  // MITOSIM_COARSE_SEGMENT_H
@@ -35,6 +35,8 @@
 #ifndef MITOSIM_CORE_TRANSFORMER_H
 #define MITOSIM_CORE_TRANSFORMER_H
 
+#include <algorithm>
+#include <array>
 #include <vector>
 
 #include "definitions.h"
@@ -48,16 +50,25 @@ namespace mitosim {
  * Forms base for clases adding more specific tapes of dynamics.
  * @tparam Mt type of the network Edge.
  */
-template<typename Mt>
+template<typename Mt, typename Ind=Index>
 class CoreTransformer
-    : public Structure<Mt> {
+    : public Structure<Mt, Ind> {
 
 protected:
 
-    using Structure<Mt>::msgr;
-    using Structure<Mt>::mt;
-    using Structure<Mt>::mtnum;
-    using Structure<Mt>::clnum;
+    using Structure<Mt, Ind>::msgr;
+    using Structure<Mt, Ind>::mt;
+    using Structure<Mt, Ind>::mtnum;
+    using Structure<Mt, Ind>::handles;
+    using Structure<Mt, Ind>::clnum;
+    using Structure<Mt, Ind>::junctions;
+    using Structure<Mt, Ind>::touch;
+    using Structure<Mt, Ind>::remove_from_cluster;
+    using Structure<Mt, Ind>::rename_in_cluster;
+    using Structure<Mt, Ind>::map_edges;
+    using Structure<Mt, Ind>::pop_segment;
+    using Structure<Mt, Ind>::reserve_g;
+    using Structure<Mt, Ind>::recluster;
 
 public:
 
@@ -71,15 +82,29 @@ public:
      * @brief Update the structure of diaconnected components produced by fusion.
      * @param w1 Index of the 1st participant segment.
      * @param w2 Index of the 2nd participant segment.
+     * @return Index of the merged component.
      */
-    constexpr void update_mtcl_fuse(szt w1, szt w2) noexcept;
+    constexpr auto update_mtcl_fuse(szt w1, szt w2) noexcept -> szt;
 
     /**
      * @brief Update the structure of diaconnected components produced by fusion.
      * @param c1 Index of the 1st participant component.
      * @param c2 Index of the 2nd participant component.
+     * @return Index of the merged component.
      */
-    constexpr void update_cl_fuse(szt c1, szt c2) noexcept;
+    constexpr auto update_cl_fuse(szt c1, szt c2) noexcept -> szt;
+
+    /**
+     * @brief Order the components to be merged by fusion.
+     * @details The smaller component is relabelled into the larger one,
+     * unless the larger one is the last, which is relabelled anyway
+     * to take the index released.
+     * @param c1 Index of the 1st participant component.
+     * @param c2 Index of the 2nd participant component.
+     * @return Indexes of the component kept and of the one relabelled.
+     */
+    constexpr auto merge_order(szt c1, szt c2) const noexcept
+        -> std::array<szt,2>;
 
     /**
      * @brief Update the diaconnected component indexes.
@@ -90,10 +115,22 @@ public:
 
     /**
      * @brief Update the diaconnected component indexes.
+     * @details Renumbers Edge::indcl over the member list of the component.
+     * Does nothing if the indexes are not stored in the edges, see
+     * Structure::indcl_offsets().
      * @param c Initial index.
      */
     constexpr void update_gIndcl(szt c) noexcept;
 
+    /**
+     * @brief Relabel the segments of a disconnected component.
+     * @details The member lists are merged by appending the shorter one,
+     * so that the cost is linear in the number of the relabelled segments.
+     * @param cf Initial index.
+     * @param ct Final index.
+     */
+    constexpr void move_cluster(szt cf, szt ct) noexcept;
+
 protected:
 
     /**
@@ -123,6 +160,16 @@ protected:
      */
     auto fuse_to_loop(szt w) noexcept -> std::array<szt,2>;
 
+    /**
+     * @brief Append the edges of one segment to those of another.
+     * @details The edges are joined in the in-segment order. Only a segment
+     * reflected differently from its partner is reversed physically.
+     * @param w1 Index of the receiving segment.
+     * @param w2 Index of the segment giving away the edges.
+     * @return Position in 'w1' storage from which the edges have moved.
+     */
+    auto join_g(szt w1, szt w2) -> szt;
+
     /**
      * @brief Update network segment indexes.
      * @details The network indexes are updatted such that segment
@@ -134,6 +181,7 @@ protected:
 
     /**
      * @brief Copy connection partners to a new segment.
+     * @details The target end takes the place of the source end at its node.
      * @param f Source segment index.
      * @param ef Source segment end.
      * @param t Target segment index.
@@ -143,6 +191,8 @@ protected:
 
     /**
      * @brief Update segment neighbours.
+     * @details Removal covers all neighbours at the end, which is then
+     * detached from its node.
      * @param oldn Old neighbour segment index.
      * @param oend Old neighbour segment end.
      * @param n1 Neighbour initial index.
@@ -165,28 +215,32 @@ protected:
 
 // IMPLEMENTATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-template<typename Mt>
-CoreTransformer<Mt>::
+template<typename Mt, typename Ind>
+CoreTransformer<Mt, Ind>::
 CoreTransformer(
         Msgr& msgr
     )
-    : Structure<Mt> {msgr}
+    : Structure<Mt, Ind> {msgr}
 {}
 
 
-template<typename Mt>
-void CoreTransformer<Mt>::
+template<typename Mt, typename Ind>
+void CoreTransformer<Mt, Ind>::
 rename_mito( const szt f, const szt t )
 {
+    touch(f);
     copy_neigs(f, 1, t, 1);
     copy_neigs(f, 2, t, 2);
-    mt[t].g = std::move(mt[f].g);
+    mt[t].take_g(mt[f]);
+    map_edges(t);
+    rename_in_cluster(f, t);
+    handles.move(f, t);
     mt[t].set_cl(mt[f].get_cl());
 }
 
 
-template<typename Mt>
-void CoreTransformer<Mt>::
+template<typename Mt, typename Ind>
+void CoreTransformer<Mt, Ind>::
 copy_neigs(
     const szt f, const szt ef,
     const szt t, const szt et
@@ -197,14 +251,16 @@ copy_neigs(
         mt[t].neen[et][j] = mt[f].neen[ef][j];
     }
     mt[t].nn[et] = mt[f].nn[ef];
+    junctions.relabel(f, ef, t, et);
+    touch(t);
 
     // Substitute f in f's neig's neigs for t:
     update_neigs(f, ef, 1, mt[f].nn[ef], t, et, false);
 }
 
 
-template<typename Mt>
-void CoreTransformer<Mt>::
+template<typename Mt, typename Ind>
+void CoreTransformer<Mt, Ind>::
 update_neigs(
     const szt oldn,
     const szt oend,
@@ -215,6 +271,12 @@ update_neigs(
     const bool removefromneigs
 ) noexcept
 {
+    if (removefromneigs) {
+        XASSERT(n1 == 1 && n2 == mt[oldn].nn[oend],
+                "Error in update_neigs: removal of a part of the neigs.\n");
+        junctions.detach(oldn, oend);
+    }
+
     for (szt j=n1; j<=n2; j++) {
         const auto cn = mt[oldn].neig[oend][j];  // our neig currently processed
         const auto ce = mt[oldn].neen[oend][j];  // our neig currently processed
@@ -231,6 +293,8 @@ update_neigs(
                 break;
         }
         if (removefromneigs) {
+            touch(oldn);
+            touch(cn);
             // Remove oldn from the neig list of its j-th neig
             mt[cn].neig[ce][i1] = mt[cn].neig[ce][mt[cn].nn[ce]];
             mt[cn].neen[ce][i1] = mt[cn].neen[ce][mt[cn].nn[ce]--];
@@ -246,16 +310,49 @@ update_neigs(
 }
 
 
-template<typename Mt>
-auto CoreTransformer<Mt>::
+template<typename Mt, typename Ind>
+auto CoreTransformer<Mt, Ind>::
+join_g(
+    const szt w1,
+    const szt w2
+) -> szt
+{
+    auto& m1 = mt[w1];
+    auto& m2 = mt[w2];
+    const auto n = m1.length() + m2.length();
+
+    if (m1.is_reversed() != m2.is_reversed()) {
+        const auto from = m1.is_reversed() ? 0 : m1.length();
+        m1.orient();
+        m2.orient();
+        reserve_g(w1, n);
+        m1.append_g(m2);
+        return from;
+    }
+    if (!m1.is_reversed()) {
+        const auto from = m1.length();
+        reserve_g(w1, n);
+        m1.append_g(m2);
+        return from;
+    }
+    // Both are reflected: the storage of w1 follows that of w2.
+    reserve_g(w2, n);
+    m2.append_g(m1);
+    m1.take_g(m2);
+    return 0;
+}
+
+
+template<typename Mt, typename Ind>
+auto CoreTransformer<Mt, Ind>::
 fuse_antiparallel(
     const szt end,
     const szt w1,
     const szt w2
 ) noexcept -> std::array<szt,2>
 {
-    [[maybe_unused]] const auto len1 = mt[w1].g.size();
-    [[maybe_unused]] const auto len2 = mt[w2].g.size();
+    [[maybe_unused]] const auto len1 = mt[w1].length();
+    [[maybe_unused]] const auto len2 = mt[w2].length();
     const auto cl1 = mt[w1].get_cl();
     const auto cl2 = mt[w2].get_cl();
 
@@ -274,36 +371,40 @@ fuse_antiparallel(
     XASSERT(!mt[w2].nn[end],
             "Error during antiparallel fusion: end of w2 is not free.\n");
 
+    touch(w1);
+    touch(w2);
+
     const szt opend = end==2 ? 1 : 2;
     if (end == 1)
         copy_neigs(w1, 2, w1, 1);    // copy w1's 1-end neigs to its 0-end
     copy_neigs(w2, opend, w1, 2);    // copy w2's 1-end neigs to w1's 1-end
 
-    if (mt[w2].get_cl() !=
-        mt[w1].get_cl())
-        update_mtcl_fuse(w1, w2);
+    // The indexes affected: the merged component and the one released.
+    auto cc = std::array<szt,2> {cl1, cl2};
+    if (cl1 != cl2) {
+        cc[0] = update_mtcl_fuse(w1, w2);
+        cc[1] = cc[0] == cl1 ? cl2 : cl1;
+    }
 
     if (end == 1)
-        // Edge::a takes values [1:g.size()];
-        // for w1 reflect positions if 1-ends are joined;
+        // Reflect w1 if 1-ends are joined;
         mt[w1].reflect_g();
     else
-        // Edge::a takes values [1:g.size()];
-        // for w2 reflect positions if 2-ends are joined;
+        // Reflect w2 if 2-ends are joined;
         mt[w2].reflect_g();
 
-    std::move(mt[w2].g.begin(),
-              mt[w2].g.end(), std::back_inserter(mt[w1].g));
-    mt[w2].g.clear();
+    map_edges(w1, join_g(w1, w2));
 
+    remove_from_cluster(w2);
+    handles.erase(w2);
     if (w2 != mtnum)
         rename_mito(mtnum, w2);
-    mt.pop_back();
+    pop_segment();
     mtnum--;
 
-    update_gIndcl(cl1);
-    if (cl1 != cl2)
-        update_gIndcl(cl2);
+    update_gIndcl(cc[0]);
+    if (cc[0] != cc[1])
+        update_gIndcl(cc[1]);
 
     if constexpr (verbose) {
         if (w1 == mtnum+1) {
@@ -317,19 +418,19 @@ fuse_antiparallel(
             if (msgr.sl) *msgr.sl << std::endl;
         }
     }
-    return {cl1, cl2};
+    return cc;
 }
 
 
-template<typename Mt>
-auto CoreTransformer<Mt>::
+template<typename Mt, typename Ind>
+auto CoreTransformer<Mt, Ind>::
 fuse_parallel(
     const szt w1,
     const szt w2
 ) noexcept -> std::array<szt,2>
 {
-    [[maybe_unused]] const auto len1 = mt[w1].g.size();
-    [[maybe_unused]] const auto len2 = mt[w2].g.size();
+    [[maybe_unused]] const auto len1 = mt[w1].length();
+    [[maybe_unused]] const auto len2 = mt[w2].length();
     const auto cl1 = mt[w1].get_cl();
     const auto cl2 = mt[w2].get_cl();
 
@@ -348,23 +449,31 @@ fuse_parallel(
     XASSERT(!mt[w2].nn[2],
             "Error during parallel fusion: end 2 of w2 is not free.\n");
 
+    touch(w1);
+    touch(w2);
+
     copy_neigs(w2, 1, w1, 1);
-    if (mt[w2].get_cl() !=
-        mt[w1].get_cl())
-        update_mtcl_fuse(w1, w2);
+    // The indexes affected: the merged component and the one released.
+    auto cc = std::array<szt,2> {cl1, cl2};
+    if (cl1 != cl2) {
+        cc[0] = update_mtcl_fuse(w1, w2);
+        cc[1] = cc[0] == cl1 ? cl2 : cl1;
+    }
 
-    std::move(mt[w1].g.begin(),
-              mt[w1].g.end(), std::back_inserter(mt[w2].g));
-    mt[w1].g = std::move(mt[w2].g);
+    join_g(w2, w1);
+    mt[w1].take_g(mt[w2]);
+    map_edges(w1);
 
+    remove_from_cluster(w2);
+    handles.erase(w2);
     if (w2 != mtnum)
         rename_mito(mtnum, w2);
-    mt.pop_back();
+    pop_segment();
     mtnum--;
 
-    update_gIndcl(cl1);
-    if (cl1 != cl2)
-        update_gIndcl(cl2);
+    update_gIndcl(cc[0]);
+    if (cc[0] != cc[1])
+        update_gIndcl(cc[1]);
 
     if constexpr (verbose) {
         if (w1 == mtnum + 1) {
@@ -379,12 +488,12 @@ fuse_parallel(
         }
     }
 
-    return {cl1, cl2};
+    return cc;
 }
 
 
-template<typename Mt>
-auto CoreTransformer<Mt>::
+template<typename Mt, typename Ind>
+auto CoreTransformer<Mt, Ind>::
 fuse_to_loop( const szt w ) noexcept -> std::array<szt,2>
 {
     XASSERT(!mt[w].is_cycle(),
@@ -394,10 +503,12 @@ fuse_to_loop( const szt w ) noexcept -> std::array<szt,2>
 
     if constexpr (verbose) {
         msgr.print("Fused to cycle: ",
-                   w, " of length ", mt[w].g.size());
+                   w, " of length ", mt[w].length());
         mt[w].print(w, "Before ", 0);
     }
 
+    touch(w);
+
     mt[w].nn[1] =
     mt[w].nn[2] = 1;
 
@@ -407,6 +518,8 @@ fuse_to_loop( const szt w ) noexcept -> std::array<szt,2>
     mt[w].neen[1][1] = 2;
     mt[w].neen[2][1] = 1;
 
+    junctions.join(w, 1, w, 2);
+
     if constexpr (verbose) {
         msgr.print("Producing ");
         mt[w].print(w, "After ", 0);
@@ -416,65 +529,116 @@ fuse_to_loop( const szt w ) noexcept -> std::array<szt,2>
 }
 
 
-template<typename Mt> constexpr
-void CoreTransformer<Mt>::
+template<typename Mt, typename Ind> constexpr
+auto CoreTransformer<Mt, Ind>::
 update_mtcl_fuse(
     const szt w1,
     const szt w2
-) noexcept
+) noexcept -> szt
 {
-    const auto w1cl = mt[w1].get_cl();
-    const auto w2cl = mt[w2].get_cl();
-
-    for (szt i=1; i<=mtnum; i++)
-        if (mt[i].get_cl() == w2cl)
-            mt[i].set_cl(w1cl);
+    const auto [ct, cf] = merge_order(mt[w1].get_cl(), mt[w2].get_cl());
 
-    if (w2cl != clnum-1)
-        for (szt i=1; i<=mtnum; i++)
-            if (mt[i].get_cl() == clnum-1)
-                mt[i].set_cl(w2cl);
+    move_cluster(cf, ct);
+    if (cf != clnum-1)
+        move_cluster(clnum-1, cf);
     clnum--;
+
+    return ct;
 }
 
 
-template<typename Mt> constexpr
-void CoreTransformer<Mt>::
+template<typename Mt, typename Ind> constexpr
+auto CoreTransformer<Mt, Ind>::
 update_cl_fuse(
     const szt c1,
     const szt c2
-) noexcept   // args by value
+) noexcept -> szt   // args by value
 {
-    update_cl(c2, c1);
-    if (c2 != clnum - 1)
-        update_cl(clnum-1, c2);
+    const auto [ct, cf] = merge_order(c1, c2);
+
+    update_cl(cf, ct);
+    if (cf != clnum - 1)
+        update_cl(clnum-1, cf);
     clnum--;
+
+    return ct;
+}
+
+
+template<typename Mt, typename Ind> constexpr
+auto CoreTransformer<Mt, Ind>::
+merge_order(
+    const szt c1,
+    const szt c2
+) const noexcept -> std::array<szt,2>
+{
+    const auto& l = this->clmt;
+
+    if (c1 == clnum-1) return {c2, c1};
+    if (c2 == clnum-1) return {c1, c2};
+
+    return l[c1].size() < l[c2].size() ? std::array {c2, c1}
+                                       : std::array {c1, c2};
 }
 
 
-template<typename Mt> constexpr
-void CoreTransformer<Mt>::
+template<typename Mt, typename Ind> constexpr
+void CoreTransformer<Mt, Ind>::
 update_cl(
     const szt cf,
     const szt ct
 ) noexcept        // args by value
 {
-    for (szt i=1; i<=mtnum; i++)
-        if (mt[i].get_cl() == cf)
-            mt[i].set_cl(ct);
+    move_cluster(cf, ct);
 
     update_gIndcl(ct);
 }
 
 
-template<typename Mt> constexpr
-void CoreTransformer<Mt>::
+template<typename Mt, typename Ind> constexpr
+void CoreTransformer<Mt, Ind>::
+move_cluster(
+    const szt cf,
+    const szt ct
+) noexcept
+{
+    if (cf == ct) return;
+
+    for (const auto i : this->clmt[cf]) {
+        mt[i].set_cl(ct);
+        recluster(i);
+    }
+
+    auto& lf = this->clmt[cf];
+    auto& lt = this->clmt[ct];
+    if (lf.size() > lt.size())
+        std::swap(lf, lt);
+    for (const auto i : lf) {
+        this->clpos[i] = lt.size();
+        lt.push_back(i);
+    }
+    lf.clear();
+}
+
+
+template<typename Mt, typename Ind> constexpr
+void CoreTransformer<Mt, Ind>::
 update_gIndcl( const szt cl ) noexcept
 {
+    // Otherwise, the order and the offsets are derived when needed.
+    if constexpr (lazy_edge_cl) return;
+
+    if (cl >= this->clmt.size()) return;
+
+    // Edge::indcl follows the segment order.
+    auto& l = this->clmt[cl];
+    std::sort(l.begin(), l.end());
+
     szt indcl {};
-    for (szt j=1; j<=mtnum; j++)
-        if (mt[j].get_cl() == cl)
-            indcl = mt[j].set_gCl(cl, indcl);
+    for (szt k=0; k<l.size(); k++) {
+        this->clpos[l[k]] = k;
+        indcl = mt[l[k]].set_gCl(cl, indcl);
+    }
 }
 
 }  // namespace mitosim
@@ -32,6 +32,7 @@
 #ifndef MITOSIM_DEFINITIONS_H
 #define MITOSIM_DEFINITIONS_H
 
+#include <cstdint>
 #include <filesystem>
 #include <string>
 
@@ -49,11 +50,46 @@ using Msgr = utils::Msgr;
 
 
 using real = float;
+
+/// Default width of the segment, cluster and edge indexes kept in the
+/// network-wide tables (see Structure).
+using Index = std::uint32_t;
+
 using RandFactory = utils::random::Boost<real>;
 
 constexpr bool verbose {};   ///< Work in verbose mode.
 constexpr bool print_edges {};   ///< Print detailed data on edges.
 
+/// Sample fusion partners from node counts instead of candidate lists.
+constexpr bool implicit_fusion_candidates {true};
+
+/// Use per-edge fission weights instead of the analytic per-segment ones.
+constexpr bool heterogeneous_fission {false};
+
+/// Store segment edges as spans over shared blocks instead of vectors.
+constexpr bool chained_edges {false};
+
+/// Reclassify only the segments changed by a transformation.
+constexpr bool incremental_structure {true};
+
+/// Check incremental structure updates against the full rebuild (slow).
+constexpr bool verify_structure {false};
+
+/// Derive Edge::cl and Edge::indcl on demand instead of storing them.
+constexpr bool lazy_edge_cl {true};
+
+/// Reduce the segments to their lengths and end topology, without the edges.
+/// Requires the homogeneous fission.
+constexpr bool coarse_segments {false};
+
+/// Draw the reaction events by the Next Reaction Method instead of
+/// the Gillespie direct method.
+constexpr bool next_reaction_method {false};
+
+/// Fire the reactions in Poisson-distributed batches over adaptive time
+/// leaps (approximate; the iterations then count the leaps).
+constexpr bool tau_leaping {false};
+
 }  // namespace mitosim
 
 #endif  // MITOSIM_DEFINITIONS_H
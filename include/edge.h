@@ -41,31 +41,62 @@ namespace mitosim {
 
 template <unsigned> class Segment;
 
+/**
+ * @brief Cluster-wide indexes of an edge.
+ * @details Stored in the edge unless lazy_edge_cl is set, in which case
+ * they are derived from the owning segment on demand
+ * (see Structure::edge_indcl()).
+ * @tparam Stored Flag to store the indexes.
+ */
+template<bool Stored>
+class EdgeClIndexes {
+
+public:
+
+    constexpr auto get_indcl() const noexcept { return indcl; }
+    void set_indcl(const szt i) noexcept { indcl = i; }
+
+    constexpr auto get_cl() const noexcept { return cl; }
+    void set_cl(const szt c) noexcept { cl = c; }
+
+private:
+
+    szt indcl {undefined<szt>};  ///< Index cluster-wide: starts from 0.
+    szt cl {undefined<szt>};     ///< Current cluster index.
+};
+
+/// Cluster-wide indexes of an edge: not stored, the setters are no-ops.
+template<>
+class EdgeClIndexes<false> {
+
+public:
+
+    constexpr auto get_indcl() const noexcept { return undefined<szt>; }
+    void set_indcl(szt) noexcept {}
+
+    constexpr auto get_cl() const noexcept { return undefined<szt>; }
+    void set_cl(szt) noexcept {}
+};
+
 /**
  * @brief The Network Edge class.
  * @details Edge is a minimal structural unit of the network.
  * The class handles the tasks and properties specific to a single edge
  * and its relation to other network components.
+ * The edge holds only its indexes: the fission-specific factors of the edge
+ * ends are stored by the Segment in separate columns.
  * @tparam ContentT Slot for specifying strucutre of the internal content
  * the Edge can hold; currently not used.
  */
 template<int ContentT>
-class Edge {
+class Edge
+    : public EdgeClIndexes<!lazy_edge_cl> {
 
     friend Segment<3>;
 
-public:
-
-    using FinT = real;
-
 private:
 
     szt ind {undefined<szt>};    ///< Index network-wide: starts from 0.
-    szt indcl {undefined<szt>};  ///< Index cluster-wide: starts from 0.
-    szt cl {undefined<szt>};     ///< Current cluster index.
-
-    /// Contribution to fission propensity at each end.
-    std::array<FinT,2> fin {};
 
 public:
 
@@ -94,21 +125,6 @@ public:
     constexpr auto get_ind() const noexcept { return ind; }
     void set_ind(const szt i) noexcept { ind = i; }
 
-    constexpr auto get_indcl() const noexcept { return indcl; }
-    void set_indcl(const szt i) noexcept { indcl = i; }
-
-    constexpr auto get_cl() const noexcept { return cl; }
-    void set_cl(const szt c) noexcept { cl = c; }
-
-    constexpr auto get_fin(const szt i) const noexcept { return fin[i]; }
-    void set_fin(const szt i,
-                 const FinT f) noexcept {
-        fin[i] = f;
-    }
-
-    /// Swap the edge ends.
-    void reflect();
-
     /**
      * @brief Read the edge from a binary file.
      * @param ofs Output file stream.
@@ -118,8 +134,10 @@ public:
     /**
      * @brief Write the edge to a binary file.
      * @param ofs Output file stream.
+     * @param indcl Index cluster-wide.
+     * @param cl Current cluster index.
      */
-    void write(std::ofstream& ofs) const;
+    void write(std::ofstream& ofs, szt indcl, szt cl) const;
 
     /**
      * @brief Print the edge to a stream.
@@ -142,38 +160,34 @@ Edge(
     const szt cl
     )
     : ind {ind}
-    , indcl {indcl}
-    , cl {cl}
-{}
-
-
-template<int ContentT>
-void Edge<ContentT>::
-reflect()
 {
-    std::swap(fin[0], fin[1]);
+    this->set_indcl(indcl);
+    this->set_cl(cl);
 }
 
+
 template<int ContentT>
 void Edge<ContentT>::
 read( std::ifstream &ifs )
 {
+    szt indcl {};
+    szt cl {};
     ifs.read(reinterpret_cast<char*>(&ind), sizeof(szt));
     ifs.read(reinterpret_cast<char*>(&indcl), sizeof(szt));
     ifs.read(reinterpret_cast<char*>(&cl), sizeof(szt));
-    ifs.read(reinterpret_cast<char*>(&fin[0]), sizeof(FinT));
-    ifs.read(reinterpret_cast<char*>(&fin[1]), sizeof(FinT));
+    this->set_indcl(indcl);
+    this->set_cl(cl);
 }
 
 template<int ContentT>
 void Edge<ContentT>::
-write( std::ofstream &ofs ) const
+write( std::ofstream &ofs,
+       const szt indcl,
+       const szt cl ) const
 {
     ofs.write(reinterpret_cast<const char*>(&ind), sizeof(szt));
     ofs.write(reinterpret_cast<const char*>(&indcl), sizeof(szt));
     ofs.write(reinterpret_cast<const char*>(&cl), sizeof(szt));
-    ofs.write(reinterpret_cast<const char*>(&fin[0]), sizeof(FinT));
-    ofs.write(reinterpret_cast<const char*>(&fin[1]), sizeof(FinT));
 }
 
 
@@ -185,8 +199,8 @@ print( std::ostream& os,
 {
     os << "[" << a << "] ";
     os << " ind " << ind; 
-    os << " indcl " << indcl;
-    os << " fin " << fin[0] << " " << fin[1];
+    if constexpr (!lazy_edge_cl)
+        os << " indcl " << this->get_indcl();
     if constexpr (ENDL) os << "\n";
 }
 
@@ -0,0 +1,655 @@
+/* =============================================================================
+   Copyright (C) 2015 Valerii Sukhorukov & Michael Meyer-Hermann,
+   Helmholtz Center for Infection Research (Braunschweig, Germany).
+   All Rights Reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all
+   copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+================================================================================
+*/
+
+/**
+ * @file edge_chain.h
+ * @brief Contains a sequence container built of spans over shared blocks.
+ * @author Valerii Sukhorukov
+ */
+
+#ifndef MITOSIM_EDGE_CHAIN_H
+#define MITOSIM_EDGE_CHAIN_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "definitions.h"
+
+namespace mitosim {
+
+/**
+ * @brief Sequence of elements stored as spans over shared blocks.
+ * @details Elements live in blocks of a fixed capacity, allocated once and
+ * never copied by splitting or concatenation: split_off() cuts a span in two
+ * spans over the same block, and append() takes over the spans of another
+ * chain. A block is released as soon as no span refers to it, so a chain
+ * keeps alive at most blockSize elements beyond its own per span.
+ * The blocks released are kept for reuse, so that the chains stop
+ * allocating once the network has settled. Like the rest of the network,
+ * the chains are not thread-safe.
+ * Random access locates the span by binary search over the span ends.
+ * Adjacent spans shorter together than half a block are copied into a block
+ * of their own where a chain is cut, joined or grown, which bounds
+ * the number of spans by 4 size() / blockSize + 1 at a constant cost
+ * per operation.
+ * @tparam T Type of the elements.
+ */
+template<typename T>
+class EdgeChain {
+
+public:
+
+    /// Capacity of a block.
+    static constexpr szt blockSize {64};
+
+private:
+
+    /// Storage of which elements [0, used) are constructed.
+    struct Block {
+        szt used {};
+        szt refs {};        ///< Spans referring to the block.
+        Block* next {};     ///< Next block kept for reuse.
+        alignas(T) std::byte raw[blockSize * sizeof(T)];
+
+        T* data() noexcept { return std::launder(reinterpret_cast<T*>(raw)); }
+    };
+
+    /// Counted reference to a block, releasing it with the last reference.
+    class Ref {
+
+    public:
+
+        Ref() = default;
+        explicit Ref(Block* b) noexcept : b {b} { b->refs++; }
+        Ref(const Ref& o) noexcept : b {o.b} { if (b) b->refs++; }
+        Ref(Ref&& o) noexcept : b {std::exchange(o.b, nullptr)} {}
+        Ref& operator=(Ref o) noexcept { std::swap(b, o.b); return *this; }
+        ~Ref() { if (b && !--b->refs) release(b); }
+
+        Block* operator->() const noexcept { return b; }
+        bool operator==(const Ref& o) const noexcept { return b == o.b; }
+
+    private:
+
+        Block* b {};
+    };
+
+    static inline Block* spare {};  ///< Blocks kept for reuse.
+
+    /// Take a block kept for reuse, or a new one.
+    static Ref acquire();
+
+    /// Destroy the elements of a block and keep it for reuse.
+    static void release(Block* b) noexcept;
+
+    /// Range [b, e) of a block, ending at position 'end' of the chain.
+    struct Span {
+        Ref block;
+        szt b {};
+        szt e {};
+        szt end {};
+
+        szt length() const noexcept { return e - b; }
+    };
+
+public:
+
+    using value_type = T;
+    using size_type = szt;
+    using reference = T&;
+    using const_reference = const T&;
+
+    /**
+     * @brief Random access iterator.
+     * @details Caches the current span for sequential traversal.
+     */
+    template<bool Const>
+    class Iter {
+
+        using Chain = std::conditional_t<Const, const EdgeChain, EdgeChain>;
+        friend class EdgeChain;
+        template<bool> friend class Iter;
+
+    public:
+
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+
+        Iter() = default;
+        operator Iter<true>() const noexcept { return {c, k}; }
+
+        reference operator*() const noexcept { return *p; }
+        pointer operator->() const noexcept { return p; }
+        reference operator[](difference_type n) const noexcept {
+            return (*c)[k + static_cast<szt>(n)];
+        }
+
+        Iter& operator++() noexcept {
+            ++p;
+            if (++k == c->spans[s].end && s + 1 < c->spans.size()) seek(s + 1);
+            return *this;
+        }
+        Iter operator++(int) noexcept { auto o = *this; ++*this; return o; }
+        Iter& operator--() noexcept {
+            if (k-- == c->start(s) && s) seek(s - 1);
+            else --p;
+            return *this;
+        }
+        Iter operator--(int) noexcept { auto o = *this; --*this; return o; }
+        Iter& operator+=(difference_type n) noexcept {
+            k += static_cast<szt>(n);
+            seek(c->span_of(k));
+            return *this;
+        }
+        Iter& operator-=(difference_type n) noexcept { return *this += -n; }
+        Iter operator+(difference_type n) const noexcept {
+            auto o = *this; return o += n;
+        }
+        friend Iter operator+(difference_type n, const Iter& i) noexcept {
+            return i + n;
+        }
+        Iter operator-(difference_type n) const noexcept {
+            auto o = *this; return o -= n;
+        }
+        difference_type operator-(const Iter& o) const noexcept {
+            return static_cast<difference_type>(k) -
+                   static_cast<difference_type>(o.k);
+        }
+        bool operator==(const Iter& o) const noexcept { return k == o.k; }
+        auto operator<=>(const Iter& o) const noexcept { return k <=> o.k; }
+
+    private:
+
+        Chain* c {};
+        szt k {};       ///< Position in the chain.
+        szt s {};       ///< Span containing k.
+        pointer p {};   ///< Element at k.
+
+        Iter(Chain* c, szt k) noexcept
+            : c {c}, k {k}
+        {
+            seek(c->span_of(k));
+        }
+
+        /// Point at position k located in span i.
+        void seek(const szt i) noexcept {
+            s = i;
+            if (c->spans.empty()) return;
+            const auto& o = c->spans[s];
+            p = o.block->data() + o.b + (k - c->start(s));
+        }
+    };
+
+    using iterator = Iter<false>;
+    using const_iterator = Iter<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    EdgeChain() = default;
+    EdgeChain(EdgeChain&&) noexcept = default;
+    EdgeChain& operator=(EdgeChain&&) noexcept = default;
+
+    /// Copies the elements into blocks of its own.
+    EdgeChain(const EdgeChain& o) { copy_from(o); }
+    EdgeChain& operator=(const EdgeChain& o);
+
+    /// Number of elements.
+    constexpr szt size() const noexcept {
+        return spans.empty() ? 0 : spans.back().end;
+    }
+    constexpr bool empty() const noexcept { return spans.empty(); }
+
+    /// Number of the spans.
+    szt num_spans() const noexcept { return spans.size(); }
+
+    T& operator[](szt k) noexcept;
+    const T& operator[](szt k) const noexcept;
+
+    T& front() noexcept { return (*this)[0]; }
+    const T& front() const noexcept { return (*this)[0]; }
+    T& back() noexcept { return (*this)[size()-1]; }
+    const T& back() const noexcept { return (*this)[size()-1]; }
+
+    iterator begin() noexcept { return {this, 0}; }
+    iterator end() noexcept { return {this, size()}; }
+    const_iterator begin() const noexcept { return {this, 0}; }
+    const_iterator end() const noexcept { return {this, size()}; }
+    reverse_iterator rbegin() noexcept { return reverse_iterator {end()}; }
+    reverse_iterator rend() noexcept { return reverse_iterator {begin()}; }
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator {end()};
+    }
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator {begin()};
+    }
+
+    /**
+     * @brief Append an element.
+     * @param v The element.
+     */
+    void push_back(T v);
+
+    /// Remove all the elements.
+    void clear() noexcept { spans.clear(); }
+
+    /**
+     * @brief Cut the chain.
+     * @param a Number of the elements to keep.
+     * @return Chain of the elements from position a onwards.
+     */
+    EdgeChain split_off(szt a);
+
+    /**
+     * @brief Cut the chain into another one.
+     * @details The span storage of the receiving chain is reused.
+     * @param a Number of the elements to keep.
+     * @param t Chain receiving the elements from position a onwards.
+     */
+    void split_off(szt a, EdgeChain& t);
+
+    /**
+     * @brief Concatenate a chain to the end of this one.
+     * @param o The chain appended, left empty.
+     */
+    void append(EdgeChain&& o);
+
+    /// Reverse the element order.
+    void reverse() noexcept;
+
+private:
+
+    std::vector<Span> spans;  ///< The spans in the element order.
+
+    /// Position of the first element of span s.
+    szt start(const szt s) const noexcept { return s ? spans[s-1].end : 0; }
+
+    /// Span containing position k, or the last span for k == size().
+    szt span_of(szt k) const noexcept;
+
+    /**
+     * @brief Copy spans s-1 and s into a new block if they are short.
+     * @param s Index of the second span.
+     */
+    void mend(szt s);
+
+    /// Replace the content with a copy of a chain.
+    void copy_from(const EdgeChain& o);
+};
+
+// IMPLEMENTATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+template<typename T>
+auto EdgeChain<T>::
+acquire() -> Ref
+{
+    if (!spare)
+        return Ref {new Block};
+
+    auto b = std::exchange(spare, spare->next);
+    b->next = nullptr;
+    return Ref {b};
+}
+
+template<typename T>
+void EdgeChain<T>::
+release( Block* b ) noexcept
+{
+    std::destroy_n(b->data(), b->used);
+    b->used = 0;
+    b->next = std::exchange(spare, b);
+}
+
+template<typename T>
+EdgeChain<T>& EdgeChain<T>::
+operator=( const EdgeChain& o )
+{
+    if (this != &o)
+        copy_from(o);
+    return *this;
+}
+
+template<typename T>
+szt EdgeChain<T>::
+span_of( const szt k ) const noexcept
+{
+    if (spans.size() < 2) return 0;
+
+    const auto s = static_cast<szt>(
+        std::upper_bound(spans.begin(), spans.end(), k,
+                         [](const szt k, const Span& o) { return k < o.end; })
+        - spans.begin());
+    return std::min(s, spans.size() - 1);
+}
+
+template<typename T>
+T& EdgeChain<T>::
+operator[]( const szt k ) noexcept
+{
+    const auto s = span_of(k);
+    return spans[s].block->data()[spans[s].b + k - start(s)];
+}
+
+template<typename T>
+const T& EdgeChain<T>::
+operator[]( const szt k ) const noexcept
+{
+    const auto s = span_of(k);
+    return spans[s].block->data()[spans[s].b + k - start(s)];
+}
+
+template<typename T>
+void EdgeChain<T>::
+push_back( T v )
+{
+    // Only the span ending at the end of the block used may grow in place.
+    if (spans.empty() ||
+        spans.back().e != spans.back().block->used ||
+        spans.back().e == blockSize) {
+        spans.push_back({acquire(), 0, 0, size()});
+        if (spans.size() > 1)
+            mend(spans.size() - 1);
+    }
+    auto& p = spans.back();
+    std::construct_at(p.block->data() + p.e, std::move(v));
+    p.block->used = ++p.e;
+    p.end++;
+}
+
+template<typename T>
+EdgeChain<T> EdgeChain<T>::
+split_off( const szt a )
+{
+    EdgeChain t;
+    split_off(a, t);
+    return t;
+}
+
+template<typename T>
+void EdgeChain<T>::
+split_off( const szt a, EdgeChain& t )
+{
+    t.clear();
+    if (a >= size()) return;
+
+    auto s = span_of(a);
+    const auto off = a - start(s);
+    if (off) {
+        // Both parts keep referring to the same block.
+        auto& p = spans[s];
+        spans.insert(spans.begin() + static_cast<long>(s) + 1,
+                     {p.block, p.b + off, p.e, p.end});
+        spans[s].e = spans[s].b + off;
+        spans[s].end = a;
+        s++;
+    }
+    for (auto i=s; i<spans.size(); i++) {
+        t.spans.push_back(std::move(spans[i]));
+        t.spans.back().end -= a;
+    }
+    spans.resize(s);
+
+    if (spans.size() > 1)
+        mend(spans.size() - 1);
+    if (t.spans.size() > 1)
+        t.mend(1);
+}
+
+template<typename T>
+void EdgeChain<T>::
+append( EdgeChain&& o )
+{
+    if (o.empty()) return;
+
+    const auto n = size();
+    const auto s = spans.size();
+    for (auto& p : o.spans) {
+        p.end += n;
+        spans.push_back(std::move(p));
+    }
+    o.clear();
+
+    if (s)
+        mend(s);
+}
+
+template<typename T>
+void EdgeChain<T>::
+reverse() noexcept
+{
+    for (auto& p : spans)
+        std::reverse(p.block->data() + p.b, p.block->data() + p.e);
+    std::reverse(spans.begin(), spans.end());
+    for (szt i=0, n=0; i<spans.size(); i++)
+        spans[i].end = n += spans[i].length();
+}
+
+template<typename T>
+void EdgeChain<T>::
+mend( const szt s )
+{
+    auto& p = spans[s-1];
+    auto& q = spans[s];
+
+    // Contiguous in the same block, as after a split being undone.
+    if (p.block == q.block && p.e == q.b) {
+        p.e = q.e;
+        p.end = q.end;
+        spans.erase(spans.begin() + static_cast<long>(s));
+        return;
+    }
+    const auto n = p.length() + q.length();
+    if (n > blockSize / 2) return;
+
+    auto b = acquire();
+    auto o = std::uninitialized_copy(p.block->data() + p.b,
+                                     p.block->data() + p.e, b->data());
+    std::uninitialized_copy(q.block->data() + q.b,
+                            q.block->data() + q.e, o);
+    b->used = n;
+    p = {std::move(b), 0, n, q.end};
+    spans.erase(spans.begin() + static_cast<long>(s));
+}
+
+template<typename T>
+void EdgeChain<T>::
+copy_from( const EdgeChain& o )
+{
+    clear();
+    for (const auto& v : o)
+        push_back(v);
+}
+
+
+/**
+ * @brief Cut a sequence of edges.
+ * @param c The sequence.
+ * @param a Number of the elements to keep.
+ * @return Sequence of the elements from position a onwards.
+ */
+template<typename T>
+EdgeChain<T> split_off( EdgeChain<T>& c, const szt a )
+{
+    return c.split_off(a);
+}
+
+template<typename T>
+std::vector<T> split_off( std::vector<T>& c, const szt a )
+{
+    const auto b = c.begin() + static_cast<long>(std::min(a, c.size()));
+    std::vector<T> t {std::make_move_iterator(b),
+                      std::make_move_iterator(c.end())};
+    c.erase(b, c.end());
+    return t;
+}
+
+/**
+ * @brief Cut a sequence of edges into another one.
+ * @details The storage of the receiving sequence is reused.
+ * @param c The sequence.
+ * @param a Number of the elements to keep.
+ * @param t The sequence receiving the elements from position a onwards.
+ */
+template<typename T>
+void split_off( EdgeChain<T>& c, const szt a, EdgeChain<T>& t )
+{
+    c.split_off(a, t);
+}
+
+template<typename T>
+void split_off( std::vector<T>& c, const szt a, std::vector<T>& t )
+{
+    const auto b = c.begin() + static_cast<long>(std::min(a, c.size()));
+    t.assign(std::make_move_iterator(b), std::make_move_iterator(c.end()));
+    c.erase(b, c.end());
+}
+
+/**
+ * @brief Make room for a number of elements, unless there is enough already.
+ * @details The storage grows geometrically, so that a buffer cycled between
+ * the segments stops reallocating once it is as long as they get.
+ * Chains are split and joined without copying, and are left as they are.
+ * @param c The sequence.
+ * @param n Number of the elements needed.
+ */
+template<typename T>
+void reserve( EdgeChain<T>&, szt ) noexcept
+{}
+
+template<typename T>
+void reserve( std::vector<T>& c, const szt n )
+{
+    if (c.capacity() < n)
+        c.reserve(std::max(n, 2 * c.capacity()));
+}
+
+/**
+ * @brief Concatenate two sequences of edges.
+ * @param c The sequence appended to.
+ * @param o The sequence appended, left empty.
+ */
+template<typename T>
+void append( EdgeChain<T>& c, EdgeChain<T>&& o )
+{
+    c.append(std::move(o));
+}
+
+template<typename T>
+void append( std::vector<T>& c, std::vector<T>&& o )
+{
+    std::move(o.begin(), o.end(), std::back_inserter(c));
+    o.clear();
+}
+
+/**
+ * @brief Reverse the element order of a sequence of edges.
+ * @param c The sequence.
+ */
+template<typename T>
+void reverse( EdgeChain<T>& c ) noexcept
+{
+    c.reverse();
+}
+
+template<typename T>
+void reverse( std::vector<T>& c ) noexcept
+{
+    std::reverse(c.begin(), c.end());
+}
+
+/**
+ * @brief Stand-in for a sequence parallel to the edges that is not stored.
+ * @details Accepts the operations on the edge sequences as no-ops,
+ * so that the segments skip the bookkeeping of the columns they do not need.
+ * @tparam T Type of the elements.
+ */
+template<typename T>
+struct NoColumn {
+
+    using value_type = T;
+
+    static constexpr auto size() noexcept -> szt { return 0; }
+    static constexpr auto empty() noexcept -> bool { return true; }
+
+    constexpr auto begin() const noexcept -> const T* { return nullptr; }
+    constexpr auto end() const noexcept -> const T* { return nullptr; }
+    constexpr auto begin() noexcept -> T* { return nullptr; }
+    constexpr auto end() noexcept -> T* { return nullptr; }
+
+    constexpr auto operator[]( szt ) const noexcept -> T { return T{}; }
+
+    constexpr void push_back( T ) noexcept {}
+    constexpr void clear() noexcept {}
+};
+
+template<typename T>
+constexpr NoColumn<T> split_off( NoColumn<T>&, szt ) noexcept
+{
+    return {};
+}
+
+template<typename T>
+constexpr void split_off( NoColumn<T>&, szt, NoColumn<T>& ) noexcept
+{}
+
+template<typename T>
+constexpr void reserve( NoColumn<T>&, szt ) noexcept
+{}
+
+template<typename T>
+constexpr void append( NoColumn<T>&, NoColumn<T>&& ) noexcept
+{}
+
+template<typename T>
+constexpr void reverse( NoColumn<T>& ) noexcept
+{}
+
+/**
+ * @brief Set an element of a sequence.
+ * @param c The sequence.
+ * @param k Position of the element.
+ * @param v New value of the element.
+ */
+template<typename C>
+void put( C& c, const szt k, typename C::value_type v )
+{
+    c[k] = std::move(v);
+}
+
+template<typename T>
+constexpr void put( NoColumn<T>&, szt, T ) noexcept
+{}
+
+}  // namespace mitosim
+
+#endif  // MITOSIM_EDGE_CHAIN_H
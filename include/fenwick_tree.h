@@ -0,0 +1,159 @@
+/* =============================================================================
+   Copyright (C) 2015 Valerii Sukhorukov & Michael Meyer-Hermann,
+   Helmholtz Center for Infection Research (Braunschweig, Germany).
+   All Rights Reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all
+   copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+================================================================================
+*/
+
+/**
+ * @file fenwick_tree.h
+ * @brief Contains a binary indexed tree for weighted random sampling.
+ * @author Valerii Sukhorukov
+ */
+
+#ifndef MITOSIM_FENWICK_TREE_H
+#define MITOSIM_FENWICK_TREE_H
+
+#include <vector>
+
+#include "definitions.h"
+
+namespace mitosim {
+
+/**
+ * @brief Binary indexed (Fenwick) tree over non-negative weights.
+ * @details Supports weight updates and inverse cumulative distribution
+ * lookup in O(log n) time, which allows for sampling an element with
+ * probability proportional to its weight.
+ * @tparam T Type of the weights.
+ */
+template<typename T>
+class FenwickTree {
+
+public:
+
+    /**
+     * @brief Reset the tree to zero weights.
+     * @param n Number of the weights.
+     */
+    void reset(szt n);
+
+    /// Number of the weights.
+    szt size() const noexcept { return w.size(); }
+
+    /**
+     * @brief Weight of an element.
+     * @param i Element index.
+     */
+    T get(const szt i) const noexcept { return w[i]; }
+
+    /**
+     * @brief Set weight of an element.
+     * @param i Element index.
+     * @param v New weight.
+     */
+    void set(szt i, T v) noexcept;
+
+    /**
+     * @brief Sum of the weights of elements preceding an element.
+     * @param i Element index.
+     */
+    T prefix(szt i) const noexcept;
+
+    /// Sum of all the weights.
+    T total() const noexcept { return prefix(w.size()); }
+
+    /**
+     * @brief Inverse cumulative distribution lookup.
+     * @param k Value in [0, total()).
+     * @param rest Set to the part of k exceeding the weights preceding
+     * the element found.
+     * @return Index i such that prefix(i) <= k < prefix(i+1).
+     */
+    szt find(T k, T& rest) const noexcept;
+
+private:
+
+    std::vector<T> tree;  ///< Partial sums, 1-based.
+    std::vector<T> w;     ///< The weights.
+    szt mask {};          ///< Highest power of 2 not exceeding the size.
+};
+
+// IMPLEMENTATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+template<typename T>
+void FenwickTree<T>::
+reset( const szt n )
+{
+    tree.assign(n + 1, zero<T>);
+    w.assign(n, zero<T>);
+    for (mask=1; mask<=n; mask<<=1);
+    mask >>= 1;
+}
+
+template<typename T>
+void FenwickTree<T>::
+set( const szt i, const T v ) noexcept
+{
+    const auto d = v - w[i];
+    if (d == zero<T>) return;
+
+    w[i] = v;
+    for (auto j=i+1; j<tree.size(); j+=j&(~j+1))
+        tree[j] += d;
+}
+
+template<typename T>
+T FenwickTree<T>::
+prefix( const szt i ) const noexcept
+{
+    T s {};
+    for (auto j=i; j; j-=j&(~j+1))
+        s += tree[j];
+
+    return s;
+}
+
+template<typename T>
+szt FenwickTree<T>::
+find( T k, T& rest ) const noexcept
+{
+    szt pos {};
+    for (auto step=mask; step; step>>=1)
+        if (pos + step < tree.size() && tree[pos+step] <= k) {
+            pos += step;
+            k -= tree[pos];
+        }
+
+    // Guard against k reaching total() due to rounding:
+    // fall back to the last element of non-zero weight.
+    if (pos >= w.size()) {
+        do pos--; while (pos && w[pos] <= zero<T>);
+        k = zero<T>;
+    }
+    rest = k;
+
+    return pos;
+}
+
+}  // namespace mitosim
+
+#endif  // MITOSIM_FENWICK_TREE_H
@@ -32,88 +32,358 @@
 #ifndef MITOSIM_FUSION_CANDIDATES_H
 #define MITOSIM_FUSION_CANDIDATES_H
 
+#include <array>
+#include <cmath>
+#include <memory_resource>
+#include <vector>
+
+#include "definitions.h"
+
 namespace mitosim {
 
 /**
  * @brief Container for fusion candidate nodes.
- * @note Should be used only for the reactions not involving fusion to a
- * disconnected cycle segment.
+ * @details Besides the node pairs, keeps for every segment the positions of
+ * the pairs it participates in. This allows for removing all pairs involving
+ * a segment in time proportional to their number, so that the container can
+ * be updated for the segments changed by a transformation rather than
+ * populated anew.
+ * The pairs are stored interleaved, one record per pair, so that sampling
+ * a pair touches a single cache line. The buffers retain their capacity
+ * when emptied, and are drawn from a memory resource given on construction.
+ * @tparam V Type of the 2nd participant index.
+ * @tparam Ind Index type.
  */
-struct alignas(8) FusionCandidatesXX {
+template<typename V,
+         typename Ind>
+class FusionCandidates {
+
+public:
+
+    /// Segment index and end index.
+    using SegEnd = std::array<Ind,2>;
 
-    static constexpr int MIN_ALIGNMENT = 8;
+    /// Node pair record.
+    struct Pair {
+        SegEnd u;               ///< Segment and end of the 1st participant.
+        V v;                    ///< Indexes of the 2nd participant.
+        std::array<Ind,2> at;   ///< Positions of the entries in 'bySeg'.
+    };
 
-    /// Segment and end indexes of the 1st participant.
-    alignas(MIN_ALIGNMENT) std::vector<std::array<szt,2>> u;
-    ///< Segment and end indexes of the 2nd participant.
-    alignas(MIN_ALIGNMENT) std::vector<std::array<szt,2>> v;
+    /**
+     * @brief Constructor.
+     * @param mr Memory resource for the buffers.
+     */
+    explicit FusionCandidates(
+        std::pmr::memory_resource* mr=std::pmr::get_default_resource()
+    )
+        // Not braces: those would list-initialize 'isRenewed' from 'mr'.
+        : pairs(mr)
+        , bySeg(mr)
+        , isRenewed(mr)
+        , renewed(mr)
+    {}
+
+    /**
+     * @brief Node pair by its position.
+     * @param p Position of the pair.
+     */
+    const Pair& operator[](const szt p) const noexcept { return pairs[p]; }
 
     /// Empty the container.
     void clear() noexcept
     {
-        u.clear();
-        v.clear();
+        pairs.clear();
+        for (auto& o : bySeg)
+            o.clear();
     }
 
     /**
      * @brief Add a node pair.
      * @param uc Segment and end indexes of the 1st participant.
-     * @param vc Segment and end indexes of the 2nd participant.
+     * @param vc Indexes of the 2nd participant.
+     */
+    void add(const SegEnd& uc,
+             const V& vc)
+    {
+        const auto p = pairs.size();
+        pairs.push_back({uc, vc, {enlist(uc[0], 2*p),
+                                  seg(vc) == uc[0] ? undefined<Ind>
+                                                   : enlist(seg(vc), 2*p + 1)}});
+    }
+
+    /**
+     * @brief Remove all pairs involving a segment.
+     * @details The order of the remaining pairs is not preserved.
+     * @param w Segment index.
+     */
+    void remove(const szt w) noexcept
+    {
+        if (w >= bySeg.size()) return;
+
+        while (!bySeg[w].empty())
+            remove_pair(bySeg[w].back() / 2);
+    }
+
+    /**
+     * @brief Renew the pairs of the segments touched by a transformation.
+     * @param touched Indexes of the touched segments, possibly repeating.
+     * @param mtnum Current number of segments.
+     * @param add_pairs Adds all current pairs of a segment given as the 1st
+     * argument; the 2nd argument tells whether a segment is renewed as well.
      */
-    void add(const std::array<szt,2>& uc,
-             const std::array<szt,2>& vc)
+    template<typename F>
+    void renew(const std::vector<szt>& touched,
+               const szt mtnum,
+               F&& add_pairs)
     {
-        u.emplace_back(uc);
-        v.emplace_back(vc);
+        renewed.clear();
+        for (const auto w : touched) {
+            if (w >= isRenewed.size())
+                isRenewed.resize(w + 1);
+            if (!isRenewed[w]) {
+                isRenewed[w] = true;
+                renewed.push_back(w);
+            }
+        }
+        const auto is_renewed = [this](const szt w) noexcept {
+            return w < isRenewed.size() && isRenewed[w];
+        };
+        for (const auto w : renewed)
+            remove(w);
+        for (const auto w : renewed)
+            if (w && w <= mtnum)
+                add_pairs(w, is_renewed);
+        for (const auto w : renewed)
+            isRenewed[w] = false;
     }
 
     /**
      * @brief Report the number of elements.
      * @result Current number of candidate fusion pairs.
      */
-    szt size() const noexcept { return u.size(); }
+    szt size() const noexcept { return pairs.size(); }
+
+private:
+
+    std::pmr::vector<Pair> pairs;  ///< The node pairs.
 
+    /// Pairs by segment: entry 2p+k refers to participant k of pair p.
+    std::pmr::vector<std::pmr::vector<Ind>> bySeg;
 
+    std::pmr::vector<bool> isRenewed;  ///< Auxiliary flags used by renew().
+    std::pmr::vector<szt>  renewed;    ///< Auxiliary list used by renew().
+
+    static szt seg(const SegEnd& x) noexcept { return x[0]; }
+    static szt seg(const Ind x) noexcept { return x; }
+
+    Ind enlist(const szt w, const szt entry)
+    {
+        if (w >= bySeg.size())
+            bySeg.resize(w + 1);
+        bySeg[w].push_back(static_cast<Ind>(entry));
+
+        return static_cast<Ind>(bySeg[w].size() - 1);
+    }
+
+    void delist(const szt w, const szt i) noexcept
+    {
+        auto& l = bySeg[w];
+        const auto moved = l.back();
+        l[i] = moved;
+        pairs[moved/2].at[moved%2] = static_cast<Ind>(i);
+        l.pop_back();
+    }
+
+    void remove_pair(const szt p) noexcept
+    {
+        delist(pairs[p].u[0], pairs[p].at[0]);
+        if (is_defined(pairs[p].at[1]))
+            delist(seg(pairs[p].v), pairs[p].at[1]);
+
+        if (p + 1 != pairs.size()) {
+            auto& o = pairs[p];
+            o = pairs.back();
+            bySeg[o.u[0]][o.at[0]] = static_cast<Ind>(2*p);
+            if (is_defined(o.at[1]))
+                bySeg[seg(o.v)][o.at[1]] = static_cast<Ind>(2*p + 1);
+        }
+        pairs.pop_back();
+    }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 /**
  * @brief Container for fusion candidate nodes.
+ * @details The 2nd participant is given by segment and end indexes.
+ * @note Should be used only for the reactions not involving fusion to a
+ * disconnected cycle segment.
+ * @tparam Ind Index type.
+ */
+template<typename Ind>
+struct FusionCandidatesXX
+    : public FusionCandidates<std::array<Ind,2>, Ind> {
+
+    using FusionCandidates<std::array<Ind,2>, Ind>::FusionCandidates;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief Container for fusion candidate nodes.
+ * @details The 1st participant is the non-looped segment, the 2nd is given
+ * by the cycle segment index.
  * @note Should be used only for fusion reactions between a cycle and a
  * non-cycle segments.
+ * @tparam Ind Index type.
  */
-struct alignas(8) FusionCandidatesXU {
+template<typename Ind>
+struct FusionCandidatesXU
+    : public FusionCandidates<Ind, Ind> {
 
-    static constexpr int MIN_ALIGNMENT = 8;
+    using FusionCandidates<Ind, Ind>::FusionCandidates;
+};
 
-    /// Segment and end indexes of the non-looped participant.
-    alignas(MIN_ALIGNMENT) std::vector<std::array<szt,2>> u;
-    /// Segment indexes of the cycle participant.
-    alignas(MIN_ALIGNMENT) std::vector<szt> v;
+////////////////////////////////////////////////////////////////////////////////
+/**
+ * @brief Registry of free (degree 1) segment ends.
+ * @details Supports fusion sampling from node counts instead of
+ * materialized candidate lists. The ends are enumerated implicitly:
+ * ends 2i and 2i+1 are ends 1 and 2 of segment mt11[i], the rest follow
+ * the order of mt13.
+ * @tparam Ind Index type of the network-wide tables.
+ */
+template<typename Ind=Index>
+class FreeEnds {
 
-    /// Empty the container.
-    void clear() noexcept
+public:
+
+    /**
+     * @brief Constructor.
+     * @param mt11 Indexes of disconnected segments not looped onto itself.
+     * @param mt13 {index,end} Pairs for segments between nodes of degs. 1 and 3.
+     */
+    explicit FreeEnds(
+        const std::vector<Ind>& mt11,
+        const std::vector<std::array<Ind,2>>& mt13
+    )
+        : mt11 {mt11}
+        , mt13 {mt13}
+    {}
+
+    /**
+     * @brief Register the loopable segments anew.
+     * @tparam Reticulum Container of the network segments.
+     * @param mt The network segments.
+     * @param mtnum Current number of segments.
+     * @param minLL Minimal length of a segment that can bend into a cycle.
+     */
+    template<typename Reticulum>
+    void reset(const Reticulum& mt, const szt mtnum, const szt minLL)
     {
-        u.clear();
-        v.clear();
+        loopable.clear();
+        loopPos.assign(mtnum + 1, undefined<Ind>);
+        for (szt w=1; w<=mtnum; w++)
+            update(mt, mtnum, w, minLL);
     }
 
     /**
-     * @brief Add a node pair.
-     * @param uc Segment and end indexes of the non-cycle participant.
-     * @param vc Segment indexes of the cycle participant.
-    */
-    void add(std::array<szt,2> uc, szt vc)
+     * @brief Update the registry for a segment changed by a transformation.
+     * @tparam Reticulum Container of the network segments.
+     * @param mt The network segments.
+     * @param mtnum Current number of segments.
+     * @param w Segment index, possibly of a segment removed.
+     * @param minLL Minimal length of a segment that can bend into a cycle.
+     */
+    template<typename Reticulum>
+    void update(const Reticulum& mt, const szt mtnum,
+                const szt w, const szt minLL)
     {
-        u.emplace_back(uc);
-        v.emplace_back(vc);
+        if (w >= loopPos.size())
+            loopPos.resize(w + 1, undefined<Ind>);
+
+        const auto is = w && w <= mtnum &&
+                        of(mt[w])[0] == 2 && mt[w].length() >= minLL;
+        const auto was = is_defined(loopPos[w]);
+        if (is && !was) {
+            loopPos[w] = static_cast<Ind>(loopable.size());
+            loopable.push_back(static_cast<Ind>(w));
+        }
+        else if (!is && was) {
+            const auto last = loopable.back();
+            loopable[loopPos[w]] = last;
+            loopPos[last] = loopPos[w];
+            loopable.pop_back();
+            loopPos[w] = undefined<Ind>;
+        }
     }
 
+    /// Total number of free ends.
+    szt size() const noexcept { return 2 * mt11.size() + mt13.size(); }
+
+    /// Number of the disconnected linear segments.
+    szt num11() const noexcept { return mt11.size(); }
+
+    /// Number of the free ends of segments between nodes of degs. 1 and 3.
+    szt num13() const noexcept { return mt13.size(); }
+
     /**
-     * @brief Report the number of elements.
-     * @return Current number of elements.
+     * @brief Free end by its index in the implicit enumeration.
+     * @param k Index of the free end.
+     * @return Segment and end indexes.
+     */
+    std::array<Ind,2> operator[](const szt k) const noexcept
+    {
+        const auto n = 2 * mt11.size();
+
+        return k < n ? std::array<Ind,2> {mt11[k/2], static_cast<Ind>(k%2 + 1)}
+                     : mt13[k - n];
+    }
+
+    /**
+     * @brief Free ends of a segment classified as in Structure.
+     * @tparam Segment Type of the network segment.
+     * @param m The segment.
+     * @return Number of the free ends followed by their end indexes.
+     */
+    template<typename Segment>
+    static std::array<Ind,3> of(const Segment& m) noexcept
+    {
+        const auto e = static_cast<Ind>(m.has_one_free_end());
+        if (e)
+            return m.nn[e == 1 ? 2 : 1] == 2 ? std::array<Ind,3> {1, e, 0}
+                                             : std::array<Ind,3> {};
+        if (!m.nn[1] && !m.nn[2])
+            return {2, 1, 2};
+
+        return {};
+    }
+
+    /// Disconnected linear segments long enough to fuse into a loop.
+    const std::vector<Ind>& get_loopable() const noexcept { return loopable; }
+
+    /**
+     * @brief Unrank a pair of distinct elements.
+     * @details Pairs {i, j}, i < j, are ranked in colexicographic order, so
+     * that ranks [0, n(n-1)/2) cover all pairs of n elements.
+     * @param r Rank of the pair.
+     * @return The pair of element indexes.
      */
-    szt size() const noexcept { return u.size(); }
+    static std::array<szt,2> unrank_pair(const szt r) noexcept
+    {
+        auto j = static_cast<szt>((1. + std::sqrt(1. + 8.*static_cast<double>(r))) / 2.);
+        while (j * (j-1) / 2 > r) j--;
+        while ((j+1) * j / 2 <= r) j++;
+
+        return {r - j*(j-1)/2, j};
+    }
+
+private:
+
+    const std::vector<Ind>&               mt11;  ///< ref: 11-segments.
+    const std::vector<std::array<Ind,2>>& mt13;  ///< ref: 13-segment ends.
+
+    std::vector<Ind> loopable;  ///< 11-segments that can fuse into a loop.
+    std::vector<Ind> loopPos;   ///< Positions of the segments in 'loopable'.
 };
 
 }  // namespace mitosim
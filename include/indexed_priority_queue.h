@@ -0,0 +1,161 @@
+/* =============================================================================
+   Copyright (C) 2015 Valerii Sukhorukov & Michael Meyer-Hermann,
+   Helmholtz Center for Infection Research (Braunschweig, Germany).
+   All Rights Reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all
+   copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+================================================================================
+*/
+
+/**
+ * @file indexed_priority_queue.h
+ * @brief Contains a binary heap with the keys addressable by element index.
+ * @author Valerii Sukhorukov
+ */
+
+#ifndef MITOSIM_INDEXED_PRIORITY_QUEUE_H
+#define MITOSIM_INDEXED_PRIORITY_QUEUE_H
+
+#include <utility>
+#include <vector>
+
+#include "definitions.h"
+
+namespace mitosim {
+
+/**
+ * @brief Indexed priority queue over a fixed set of elements.
+ * @details A binary min-heap of the element keys, which also tracks the heap
+ * position of every element. The element of the smallest key is found
+ * in O(1) time, and the key of any element is changed in O(log n) time.
+ * @tparam T Type of the keys.
+ */
+template<typename T>
+class IndexedPriorityQueue {
+
+public:
+
+    /**
+     * @brief Reset the queue to the keys given.
+     * @param keys Keys of the elements, indexed by element.
+     */
+    void reset(std::vector<T> keys);
+
+    /// Number of the elements.
+    szt size() const noexcept { return key.size(); }
+
+    /// Index of the element of the smallest key.
+    szt top() const noexcept { return heap.front(); }
+
+    /**
+     * @brief Key of an element.
+     * @param i Element index.
+     */
+    T get(const szt i) const noexcept { return key[i]; }
+
+    /**
+     * @brief Change the key of an element.
+     * @param i Element index.
+     * @param v New key.
+     */
+    void set(szt i, T v) noexcept;
+
+private:
+
+    std::vector<T>   key;   ///< Keys indexed by element.
+    std::vector<szt> heap;  ///< Elements in the heap order.
+    std::vector<szt> pos;   ///< Heap position of each element.
+
+    /// Key at a heap position.
+    T at(const szt h) const noexcept { return key[heap[h]]; }
+
+    /// Exchange two heap positions.
+    void swap(szt h1, szt h2) noexcept;
+
+    /// Move an element towards the root while it precedes its parent.
+    void sift_up(szt h) noexcept;
+
+    /// Move an element towards the leaves while a child precedes it.
+    void sift_down(szt h) noexcept;
+};
+
+// IMPLEMENTATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+template<typename T>
+void IndexedPriorityQueue<T>::
+reset( std::vector<T> keys )
+{
+    key = std::move(keys);
+    heap.resize(key.size());
+    pos.resize(key.size());
+    for (szt i=0; i<key.size(); i++)
+        heap[i] = pos[i] = i;
+
+    for (auto h=key.size()/2; h--; )
+        sift_down(h);
+}
+
+template<typename T>
+void IndexedPriorityQueue<T>::
+set( const szt i, const T v ) noexcept
+{
+    const auto old = key[i];
+    key[i] = v;
+    if (v < old)
+        sift_up(pos[i]);
+    else if (old < v)
+        sift_down(pos[i]);
+}
+
+template<typename T>
+void IndexedPriorityQueue<T>::
+swap( const szt h1, const szt h2 ) noexcept
+{
+    std::swap(heap[h1], heap[h2]);
+    pos[heap[h1]] = h1;
+    pos[heap[h2]] = h2;
+}
+
+template<typename T>
+void IndexedPriorityQueue<T>::
+sift_up( szt h ) noexcept
+{
+    while (h && at(h) < at((h - 1) / 2)) {
+        swap(h, (h - 1) / 2);
+        h = (h - 1) / 2;
+    }
+}
+
+template<typename T>
+void IndexedPriorityQueue<T>::
+sift_down( szt h ) noexcept
+{
+    for (auto c=2*h+1; c<heap.size(); c=2*h+1) {
+        if (c + 1 < heap.size() && at(c + 1) < at(c))
+            c++;
+        if (!(at(c) < at(h)))
+            break;
+        swap(h, c);
+        h = c;
+    }
+}
+
+}  // namespace mitosim
+
+#endif  // MITOSIM_INDEXED_PRIORITY_QUEUE_H
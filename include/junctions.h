@@ -0,0 +1,270 @@
+/* =============================================================================
+   Copyright (C) 2015 Valerii Sukhorukov & Michael Meyer-Hermann,
+   Helmholtz Center for Infection Research (Braunschweig, Germany).
+   All Rights Reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all
+   copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+================================================================================
+*/
+
+/**
+ * @file junctions.h
+ * @brief Contains the table of the network nodes joining segment ends.
+ * @author Valerii Sukhorukov
+ */
+
+#ifndef MITOSIM_JUNCTIONS_H
+#define MITOSIM_JUNCTIONS_H
+
+#include <array>
+#include <vector>
+
+#include "definitions.h"
+
+namespace mitosim {
+
+/**
+ * @brief Table of the nodes at which segment ends are joined.
+ * @details Each node has a stable id, the (segment, end) slots incident
+ * to it and its degree, while every connected segment end points at its
+ * node. Nodes of degree 3 are the junctions; nodes of degree 2 occur where
+ * a cycle closes on itself. Free ends belong to no node. The table is
+ * written by the transformations along with the 'neig' and 'neen' lists
+ * of the segments, each junction update taking constant time. A node
+ * keeps its id for as long as it exists; the ids of removed nodes are
+ * reused.
+ * @tparam Ind Index type.
+ */
+template<typename Ind>
+class Junctions {
+
+public:
+
+    /// Segment index and end index.
+    using SegEnd = std::array<Ind,2>;
+
+    /// Node joining segment ends.
+    struct Node {
+        std::array<SegEnd,3> slots {};  ///< Incident segment ends.
+        Ind deg {};                     ///< Number of the incident ends.
+    };
+
+    /**
+     * @brief Open a node joining two free segment ends.
+     * @param w1 Segment index of the 1st end.
+     * @param e1 Segment end of the 1st end.
+     * @param w2 Segment index of the 2nd end.
+     * @param e2 Segment end of the 2nd end.
+     * @return Id of the node.
+     */
+    auto join(szt w1, szt e1, szt w2, szt e2) -> Ind;
+
+    /**
+     * @brief Attach a free segment end to a node.
+     * @param k Node id.
+     * @param w Segment index.
+     * @param e Segment end.
+     */
+    void attach(Ind k, szt w, szt e);
+
+    /**
+     * @brief Detach a segment end from its node.
+     * @details A node left with a single end is removed, freeing that end.
+     * @param w Segment index.
+     * @param e Segment end.
+     */
+    void detach(szt w, szt e) noexcept;
+
+    /**
+     * @brief Substitute a segment end in the slots of its node.
+     * @details The former end is left free. Free ends are moved as free.
+     * @param f Current segment index.
+     * @param ef Current segment end.
+     * @param t New segment index.
+     * @param et New segment end, expected to be free.
+     */
+    void relabel(szt f, szt ef, szt t, szt et);
+
+    /**
+     * @brief Node at a segment end.
+     * @param w Segment index.
+     * @param e Segment end.
+     * @return Node id, or undefined<Ind> if the end is free.
+     */
+    Ind at(const szt w, const szt e) const noexcept
+    {
+        return w < endNode.size() ? endNode[w][e-1] : undefined<Ind>;
+    }
+
+    /**
+     * @brief Node by id.
+     * @param k Node id.
+     */
+    const Node& operator[](const szt k) const noexcept { return nodes[k]; }
+
+    /**
+     * @brief Tell if a node has a given segment end among its slots.
+     * @param k Node id.
+     * @param w Segment index.
+     * @param e Segment end.
+     */
+    bool has(szt k, szt w, szt e) const noexcept;
+
+    /**
+     * @brief Number of the nodes of a given degree.
+     * @param deg Node degree.
+     */
+    szt num(const szt deg) const noexcept { return numByDeg[deg]; }
+
+private:
+
+    std::vector<Node> nodes;                  ///< Nodes by id.
+    std::vector<std::array<Ind,2>> endNode;   ///< Node ids at segment ends.
+    std::vector<Ind> freeIds;                 ///< Ids available for reuse.
+    std::array<szt,4> numByDeg {};            ///< Number of nodes by degree.
+
+    /// Points a segment end at a node, growing the map as needed.
+    void point(szt w, szt e, Ind k);
+
+    /// Moves a node to another degree in the count.
+    void set_deg(Node& n, const Ind d) noexcept
+    {
+        if (n.deg) numByDeg[n.deg]--;
+        if (d) numByDeg[d]++;
+        n.deg = d;
+    }
+};
+
+// IMPLEMENTATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+template<typename Ind>
+auto Junctions<Ind>::
+join(
+    const szt w1, const szt e1,
+    const szt w2, const szt e2
+) -> Ind
+{
+    Ind k;
+    if (freeIds.empty()) {
+        k = static_cast<Ind>(nodes.size());
+        nodes.emplace_back();
+        // Keeps detach() from reallocating.
+        freeIds.reserve(nodes.capacity());
+    }
+    else {
+        k = freeIds.back();
+        freeIds.pop_back();
+    }
+    attach(k, w1, e1);
+    attach(k, w2, e2);
+
+    return k;
+}
+
+template<typename Ind>
+void Junctions<Ind>::
+attach( const Ind k, const szt w, const szt e )
+{
+    XASSERT(!is_defined(at(w, e)), "Junctions: attaching a linked end.\n");
+
+    auto& n = nodes[k];
+    XASSERT(n.deg < n.slots.size(), "Junctions: node degree exceeded.\n");
+
+    n.slots[n.deg] = {static_cast<Ind>(w), static_cast<Ind>(e)};
+    set_deg(n, n.deg + 1);
+    point(w, e, k);
+}
+
+template<typename Ind>
+void Junctions<Ind>::
+detach( const szt w, const szt e ) noexcept
+{
+    const auto k = at(w, e);
+    if (!is_defined(k)) return;
+
+    auto& n = nodes[k];
+    const SegEnd we {static_cast<Ind>(w), static_cast<Ind>(e)};
+    for (Ind i=0; i<n.deg; i++)
+        if (n.slots[i] == we) {
+            n.slots[i] = n.slots[n.deg-1];
+            break;
+        }
+    n.slots[n.deg-1] = {};
+    set_deg(n, n.deg - 1);
+    endNode[w][e-1] = undefined<Ind>;
+
+    if (n.deg == 1) {
+        const auto [w1, e1] = n.slots[0];
+        endNode[w1][e1-1] = undefined<Ind>;
+        n.slots[0] = {};
+        set_deg(n, 0);
+        freeIds.push_back(k);
+    }
+}
+
+template<typename Ind>
+void Junctions<Ind>::
+relabel(
+    const szt f, const szt ef,
+    const szt t, const szt et
+)
+{
+    const auto k = at(f, ef);
+    if (!is_defined(k)) {
+        XASSERT(!is_defined(at(t, et)), "Junctions: relabel to a linked end.\n");
+        return;
+    }
+    XASSERT(!is_defined(at(t, et)) || (f == t && ef == et),
+            "Junctions: relabel to a linked end.\n");
+
+    auto& n = nodes[k];
+    const SegEnd fe {static_cast<Ind>(f), static_cast<Ind>(ef)};
+    for (Ind i=0; i<n.deg; i++)
+        if (n.slots[i] == fe)
+            n.slots[i] = {static_cast<Ind>(t), static_cast<Ind>(et)};
+    endNode[f][ef-1] = undefined<Ind>;
+    point(t, et, k);
+}
+
+template<typename Ind>
+bool Junctions<Ind>::
+has( const szt k, const szt w, const szt e ) const noexcept
+{
+    const SegEnd we {static_cast<Ind>(w), static_cast<Ind>(e)};
+    const auto& n = nodes[k];
+    for (Ind i=0; i<n.deg; i++)
+        if (n.slots[i] == we)
+            return true;
+
+    return false;
+}
+
+template<typename Ind>
+void Junctions<Ind>::
+point( const szt w, const szt e, const Ind k )
+{
+    if (w >= endNode.size())
+        endNode.resize(w + 1, {undefined<Ind>, undefined<Ind>});
+
+    endNode[w][e-1] = k;
+}
+
+}  // namespace mitosim
+
+#endif  // MITOSIM_JUNCTIONS_H
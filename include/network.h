@@ -32,6 +32,10 @@
 #ifndef MITOSIM_NETWORK_H
 #define MITOSIM_NETWORK_H
 
+#include <array>
+#include <memory_resource>
+#include <vector>
+
 #include "ability_for_fusion.h"
 #include "config.h"
 #include "definitions.h"
@@ -49,23 +53,24 @@ namespace mitosim {
  * both fusion and division.
  * @tparam SegmentT type of the segment used by the network.
  */
-template<typename SegmentT>
+template<typename SegmentT, typename Ind=Index>
 class Network
-    :  public AbilityForFusion<SegmentT> {
+    :  public AbilityForFusion<SegmentT, Ind> {
 
 public:
 
-    using thisT = Network<SegmentT>;
+    using thisT = Network<SegmentT, Ind>;
     using ST = SegmentT;
 
-    using Structure<SegmentT>::add_disconnected_segment;
-    using Structure<SegmentT>::clnum;
-    using Structure<SegmentT>::glm;
-    using Structure<SegmentT>::msgr;
-    using Structure<SegmentT>::mt;
-    using Structure<SegmentT>::mtmass;
-    using Structure<SegmentT>::mtnum;
-    using Structure<SegmentT>::nn;
+    using Structure<SegmentT, Ind>::add_disconnected_segment;
+    using Structure<SegmentT, Ind>::clnum;
+    using Structure<SegmentT, Ind>::glm;
+    using Structure<SegmentT, Ind>::handles;
+    using Structure<SegmentT, Ind>::msgr;
+    using Structure<SegmentT, Ind>::mt;
+    using Structure<SegmentT, Ind>::mtmass;
+    using Structure<SegmentT, Ind>::mtnum;
+    using Structure<SegmentT, Ind>::nn;
 
     friend Fission<thisT>;
     friend Fusion<1,0,thisT>;
@@ -75,10 +80,10 @@ public:
     friend Fusion12<thisT>;
     friend Fusion1U<thisT>;
     friend NtwFission<thisT>;
-    friend NtwFusion11<thisT>;
-    friend NtwFusion12<thisT>;
-    friend NtwFusion1U<thisT>;
-    friend Simulation<thisT>;
+    friend NtwFusion11<thisT,implicit_fusion_candidates>;
+    friend NtwFusion12<thisT,implicit_fusion_candidates>;
+    friend NtwFusion1U<thisT,implicit_fusion_candidates>;
+    template<typename, typename> friend class Simulation;
 
     RandFactory&  rnd;   ///< Random number factory.
     double        time;  ///< Current time.
@@ -87,20 +92,25 @@ public:
 
     // Reaction slots:
     NtwFission<thisT>  fis;   ///< Slot for fission reaction.
-    NtwFusion11<thisT> fu11;  ///< Slot for fusion raction of nodes degr. 1+1.
-    NtwFusion12<thisT> fu12;  ///< Slot for fusion reaction of nodes degr. 1+2.
-    NtwFusion1U<thisT> fu1L;  ///< Slot for fusion raction of nodes degr. 1 and a cycle.
+    /// Slot for fusion raction of nodes degr. 1+1.
+    NtwFusion11<thisT,implicit_fusion_candidates> fu11;
+    /// Slot for fusion reaction of nodes degr. 1+2.
+    NtwFusion12<thisT,implicit_fusion_candidates> fu12;
+    /// Slot for fusion raction of nodes degr. 1 and a cycle.
+    NtwFusion1U<thisT,implicit_fusion_candidates> fu1L;
 
     /**
      * @brief Constructor.
      * @param cfg Configuration object.
      * @param rnd Random number factory.
      * @param msgr Output message processor.
+     * @param mr Memory resource for the fusion candidate buffers.
      */
     explicit Network(
             const Config<real>& cfg,
             RandFactory& rnd,
-            Msgr& msgr
+            Msgr& msgr,
+            std::pmr::memory_resource* mr=std::pmr::get_default_resource()
     );
 
     /// Produce everything necessary for the simulation to start.
@@ -117,6 +127,34 @@ private:
     /// Update the network state variables
     void update_books() noexcept;
 
+    // Record of the events applied in a batch, see BatchedReaction.
+    std::vector<szt>  changed;      ///< Segments changed in the batch.
+    std::vector<szt>  changedCl;    ///< Clusters changed in the batch.
+    std::vector<bool> isChanged;    ///< Flags of the segments in 'changed'.
+    std::vector<bool> isChangedCl;  ///< Flags of the clusters in 'changedCl'.
+
+    /**
+     * @brief Start a new batch of events, forgetting the previous one.
+     * @details The structure updates are deferred until the batch is closed.
+     */
+    void open_batch() noexcept;
+
+    /// Close the current batch, bringing the structure up to date.
+    void close_batch() noexcept;
+
+    /**
+     * @brief Record an event applied in the current batch.
+     * @details The segments touched by the event are moved to the record.
+     * @param cc Clusters changed by the event.
+     */
+    void record(const std::array<szt,2>& cc);
+
+    /**
+     * @brief Tells if a segment was changed in the current batch.
+     * @param w Segment index.
+     */
+    bool is_changed(szt w) const noexcept;
+
     /**
      * @brief Write network to a file.
      * @param startnew Start a new file vs. adding new data records.
@@ -134,27 +172,28 @@ private:
 
 // IMPLEMENTATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-template<typename SegmentT>
-Network<SegmentT>::
+template<typename SegmentT, typename Ind>
+Network<SegmentT, Ind>::
 Network(
         const Config<real>& cfg,
         RandFactory& rnd,
-        Msgr& msgr
+        Msgr& msgr,
+        std::pmr::memory_resource* mr
     )
-    : AbilityForFusion<SegmentT> {msgr}
+    : AbilityForFusion<SegmentT, Ind> {msgr}
     , rnd {rnd}
     , time {zero<double>}
     , it {}
     , cfg {cfg}
     , fis {*this}
-    , fu11 {*this}
-    , fu12 {*this}
-    , fu1L {*this}
+    , fu11 {*this, mr}
+    , fu12 {*this, mr}
+    , fu1L {*this, mr}
 {}
 
 
-template<typename SegmentT>
-auto Network<SegmentT>::
+template<typename SegmentT, typename Ind>
+auto Network<SegmentT, Ind>::
 assemble() -> thisT*
 {
     generate_components();
@@ -163,8 +202,8 @@ assemble() -> thisT*
 }
 
 
-template<typename SegmentT>
-void Network<SegmentT>::
+template<typename SegmentT, typename Ind>
+void Network<SegmentT, Ind>::
 simulate()
 {
     Simulation sim {*this, rnd, time, it, msgr};
@@ -172,8 +211,8 @@ simulate()
 }
 
 
-template<typename SegmentT>
-void Network<SegmentT>::
+template<typename SegmentT, typename Ind>
+void Network<SegmentT, Ind>::
 generate_components()
 {
     // Desired initial number of sedments.
@@ -181,6 +220,10 @@ generate_components()
     if (num < 1)
         msgr.exit("The system should have at least one segment initially");
 
+    // Pre-size for the segment number to double as the network fragments,
+    // plus the mock segment. Past that, the pages are added on demand.
+    mt.reserve(2*num + 1);
+
     szt m {mtnum};      // initial number of segments
     while (mtnum - m <= num-1)
         add_disconnected_segment(cfg.segmassini);
@@ -189,16 +232,75 @@ generate_components()
 }
 
 
-template<typename SegmentT>
-void Network<SegmentT>::
+template<typename SegmentT, typename Ind>
+void Network<SegmentT, Ind>::
 update_books() noexcept
 {
     this->update_structure();
 }
 
 
-template<typename SegmentT>
-void Network<SegmentT>::
+template<typename SegmentT, typename Ind>
+void Network<SegmentT, Ind>::
+open_batch() noexcept
+{
+    for (const auto w : changed)
+        isChanged[w] = false;
+    for (const auto c : changedCl)
+        isChangedCl[c] = false;
+    changed.clear();
+    changedCl.clear();
+    this->deferred = true;
+}
+
+
+template<typename SegmentT, typename Ind>
+void Network<SegmentT, Ind>::
+close_batch() noexcept
+{
+    if (!this->deferred) return;
+
+    this->deferred = false;
+    update_books();
+}
+
+
+template<typename SegmentT, typename Ind>
+void Network<SegmentT, Ind>::
+record( const std::array<szt,2>& cc )
+{
+    for (const auto w : this->touched) {
+        if (w >= isChanged.size())
+            isChanged.resize(w + 1);
+        if (!isChanged[w]) {
+            isChanged[w] = true;
+            changed.push_back(w);
+        }
+    }
+    this->touched.clear();
+
+    for (const auto c : cc) {
+        if (!is_defined(c)) continue;
+        if (c >= isChangedCl.size())
+            isChangedCl.resize(c + 1);
+        if (!isChangedCl[c]) {
+            isChangedCl[c] = true;
+            changedCl.push_back(c);
+        }
+    }
+}
+
+
+template<typename SegmentT, typename Ind>
+bool Network<SegmentT, Ind>::
+is_changed( const szt w ) const noexcept
+{
+    return w < isChanged.size() && isChanged[w];
+}
+
+
+template<typename SegmentT, typename Ind>
+void Network<SegmentT, Ind>::
 save_mitos(
     const bool startnew,
     const bool last,
@@ -230,8 +332,9 @@ save_mitos(
         if (mtnum > mtnummax)
             mtnummax = mtnum;
     }
+    const auto offsets = this->indcl_offsets();
     for (szt q=1; q<=mtnum; q++) {
-        mt[q].write(ofs);
+        mt[q].write(ofs, offsets[q]);
         if (!last) {
             if (mt[q].nn[1] > nn1max) nn1max = mt[q].nn[1];
             if (mt[q].nn[2] > nn2max) nn2max = mt[q].nn[2];
@@ -0,0 +1,241 @@
+/* =============================================================================
+   Copyright (C) 2015 Valerii Sukhorukov & Michael Meyer-Hermann,
+   Helmholtz Center for Infection Research (Braunschweig, Germany).
+   All Rights Reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all
+   copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+================================================================================
+*/
+
+/**
+ * @file next_reaction.h
+ * @brief Contains the Next Reaction Method engine of the simulation.
+ * @author Valerii Sukhorukov
+ */
+
+#ifndef MITOSIM_NEXT_REACTION_H
+#define MITOSIM_NEXT_REACTION_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "definitions.h"
+#include "indexed_priority_queue.h"
+
+namespace mitosim {
+
+/**
+ * @brief Next Reaction Method (Gibson and Bruck, 2000) engine.
+ * @details A drop-in alternative to utils::stochastic::Gillespie.
+ * Every reaction channel keeps a putative firing time in an indexed
+ * priority queue, so that the next event is found without scanning the
+ * scores. After an event, only the times of the fired channel and of its
+ * 'dependents' are revised, and those of the channels whose score did
+ * not change are kept. A reaction therefore has to list among its
+ * dependents every reaction whose score its firing may change.
+ * @tparam RandFactoryT Random number factory.
+ * @tparam ReactionT Base class of the reactions.
+ */
+template<typename RandFactoryT,
+         typename ReactionT>
+class NextReaction {
+
+public:
+
+    /// Type of the reaction scores.
+    using Score = std::remove_pointer_t<decltype(std::declval<ReactionT&>().score)>;
+
+    /**
+     * @brief Constructor.
+     * @param rnd Random number factory.
+     */
+    explicit NextReaction(RandFactoryT& rnd);
+
+    /**
+     * @brief Add a reaction channel.
+     * @param r The reaction.
+     */
+    void add_reaction(std::unique_ptr<ReactionT> r);
+
+    /// Set the scores and draw the first putative times.
+    void initialize();
+
+    /// Report if any of the reactions can fire.
+    bool set_asum() const noexcept;
+
+    /// Waiting time before the last event.
+    constexpr auto tau() const noexcept { return tau_; }
+
+    /**
+     * @brief Execute the earliest of the reactions.
+     * @param time Current time, advanced to the time of the event.
+     */
+    void fire(double& time);
+
+    /// Output the waiting time to a log file.
+    void log_data(std::ostream& os) const;
+
+    /// Output the reaction scores to a log file.
+    void print_scores(std::ostream& os) const;
+
+private:
+
+    static constexpr auto never = std::numeric_limits<double>::infinity();
+
+    RandFactoryT& rnd;  ///< ref: Random number factory.
+
+    vup<ReactionT> rc;  ///< The reactions.
+
+    std::vector<Score> sc;    ///< Current scores, written by the reactions.
+    std::vector<Score> used;  ///< Scores the putative times rely on.
+
+    /// Channels to revise after each of the channels fires.
+    std::vector<std::vector<szt>> dep;
+
+    IndexedPriorityQueue<double> next;  ///< Putative times.
+
+    double clock {};  ///< Time of the last event since initialization.
+    double tau_ {};   ///< Waiting time before the last event.
+
+    /**
+     * @brief Draw the time of the next event of a channel.
+     * @param a Score of the channel.
+     */
+    auto draw(Score a) -> double;
+};
+
+// IMPLEMENTATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+template<typename RandFactoryT, typename ReactionT>
+NextReaction<RandFactoryT, ReactionT>::
+NextReaction( RandFactoryT& rnd )
+    : rnd {rnd}
+{}
+
+
+template<typename RandFactoryT, typename ReactionT>
+void NextReaction<RandFactoryT, ReactionT>::
+add_reaction( std::unique_ptr<ReactionT> r )
+{
+    rc.push_back(std::move(r));
+}
+
+
+template<typename RandFactoryT, typename ReactionT>
+void NextReaction<RandFactoryT, ReactionT>::
+initialize()
+{
+    sc.assign(rc.size(), Score {});
+    for (szt i=0; i<rc.size(); i++)
+        rc[i]->score = &sc[i];
+    for (auto& r : rc)
+        r->initialize_dependencies(rc);
+
+    dep.resize(rc.size());
+    for (szt i=0; i<rc.size(); i++) {
+        dep[i] = {i};
+        for (const auto o : rc[i]->dependents)
+            for (szt j=0; j<rc.size(); j++)
+                if (rc[j].get() == o && j != i)
+                    dep[i].push_back(j);
+    }
+
+    used = sc;
+    std::vector<double> t(rc.size());
+    for (szt i=0; i<rc.size(); i++)
+        t[i] = draw(sc[i]);
+    next.reset(std::move(t));
+}
+
+
+template<typename RandFactoryT, typename ReactionT>
+bool NextReaction<RandFactoryT, ReactionT>::
+set_asum() const noexcept
+{
+    return next.size() && next.get(next.top()) < never;
+}
+
+
+template<typename RandFactoryT, typename ReactionT>
+void NextReaction<RandFactoryT, ReactionT>::
+fire( double& time )
+{
+    const auto mu = next.top();
+    const auto t = next.get(mu);
+    tau_ = t - clock;
+    time += tau_;
+    clock = t;
+
+    rc[mu]->fire();
+
+    for (const auto j : dep[mu]) {
+        const auto a = sc[j];
+        if (j == mu)
+            next.set(j, draw(a));
+        else if (a != used[j]) {
+            // Rescaling the remaining time reuses the random number drawn.
+            const auto tj = next.get(j);
+            next.set(j, a <= Score {}  ? never
+                      : tj < never     ? clock + (tj - clock) * used[j] / a
+                      : /* revived */    draw(a));
+        }
+        used[j] = a;
+    }
+}
+
+
+template<typename RandFactoryT, typename ReactionT>
+auto NextReaction<RandFactoryT, ReactionT>::
+draw( const Score a ) -> double
+{
+    if (a <= Score {})
+        return never;
+
+    // uniform0 samples [0, 1), so that the logarithm stays finite.
+    const auto u = one<real> - rnd.uniform0(one<real>);
+
+    return clock - std::log(static_cast<double>(u)) / a;
+}
+
+
+template<typename RandFactoryT, typename ReactionT>
+void NextReaction<RandFactoryT, ReactionT>::
+log_data( std::ostream& os ) const
+{
+    os << " tau " << tau_;
+}
+
+
+template<typename RandFactoryT, typename ReactionT>
+void NextReaction<RandFactoryT, ReactionT>::
+print_scores( std::ostream& os ) const
+{
+    for (const auto s : sc)
+        os << " " << s;
+}
+
+}  // namespace mitosim
+
+#endif  // MITOSIM_NEXT_REACTION_H
@@ -0,0 +1,166 @@
+/* =============================================================================
+   Copyright (C) 2015 Valerii Sukhorukov & Michael Meyer-Hermann,
+   Helmholtz Center for Infection Research (Braunschweig, Germany).
+   All Rights Reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all
+   copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+================================================================================
+*/
+
+/**
+ * @file paged_vector.h
+ * @brief Contains a sequence container keeping its elements in place.
+ * @author Valerii Sukhorukov
+ */
+
+#ifndef MITOSIM_PAGED_VECTOR_H
+#define MITOSIM_PAGED_VECTOR_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "definitions.h"
+
+namespace mitosim {
+
+/**
+ * @brief Sequence container storing its elements in fixed-size pages.
+ * @details Unlike std::vector, growth only adds pages, so that the
+ * elements are never relocated: references to them stay valid until
+ * the element is removed. Pages are retained when the elements are
+ * removed, and the appends that follow reuse them.
+ * @tparam T Type of the elements.
+ * @tparam PageSize Number of elements per page, a power of 2.
+ */
+template<typename T,
+         szt PageSize=256>
+class PagedVector {
+
+    static_assert(PageSize && !(PageSize & (PageSize - 1)),
+                  "PagedVector page size should be a power of 2");
+
+public:
+
+    using value_type = T;
+
+    PagedVector() = default;
+    PagedVector(const PagedVector&) = delete;
+    PagedVector& operator=(const PagedVector&) = delete;
+    PagedVector(PagedVector&& o) noexcept
+        : pages {std::move(o.pages)}
+        , num {std::exchange(o.num, 0)}
+    {}
+    PagedVector& operator=(PagedVector&& o) noexcept
+    {
+        if (this != &o) {
+            clear();
+            pages = std::move(o.pages);
+            num = std::exchange(o.num, 0);
+        }
+        return *this;
+    }
+    ~PagedVector() { clear(); }
+
+    /// Number of the elements.
+    szt size() const noexcept { return num; }
+
+    /// Tells if the container has no elements.
+    bool empty() const noexcept { return !num; }
+
+    /// Number of the elements the allocated pages can hold.
+    szt capacity() const noexcept { return pages.size() * PageSize; }
+
+    /**
+     * @brief Allocate the pages for a number of the elements.
+     * @details The pages are left uninitialized.
+     * @param n Number of the elements.
+     */
+    void reserve(szt n);
+
+    /**
+     * @brief Construct an element at the end.
+     * @param args Arguments forwarded to the element constructor.
+     * @return Reference to the new element.
+     */
+    template<typename... Args>
+    T& emplace_back(Args&&... args);
+
+    /// Destroy all elements, retaining the pages.
+    void clear() noexcept { while (num) pop_back(); }
+
+    /// Destroy the last element.
+    void pop_back() noexcept { std::destroy_at(&back()); num--; }
+
+    T& back() noexcept { return (*this)[num - 1]; }
+    const T& back() const noexcept { return (*this)[num - 1]; }
+
+    T& operator[](const szt i) noexcept
+    {
+        return *std::launder(reinterpret_cast<T*>(
+            &pages[i / PageSize][i % PageSize]));
+    }
+    const T& operator[](const szt i) const noexcept
+    {
+        return *std::launder(reinterpret_cast<const T*>(
+            &pages[i / PageSize][i % PageSize]));
+    }
+
+private:
+
+    /// Uninitialized storage for an element.
+    struct alignas(T) Slot {
+        std::byte b[sizeof(T)];
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> pages;  ///< The pages.
+    szt num {};                                  ///< Number of the elements.
+};
+
+// IMPLEMENTATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+template<typename T, szt PageSize>
+void PagedVector<T, PageSize>::
+reserve( const szt n )
+{
+    pages.reserve((n + PageSize - 1) / PageSize);
+    while (capacity() < n)
+        pages.emplace_back(std::make_unique_for_overwrite<Slot[]>(PageSize));
+}
+
+template<typename T, szt PageSize>
+template<typename... Args>
+T& PagedVector<T, PageSize>::
+emplace_back( Args&&... args )
+{
+    if (num == capacity())
+        pages.emplace_back(std::make_unique_for_overwrite<Slot[]>(PageSize));
+
+    auto p = new (&pages[num / PageSize][num % PageSize])
+                 T(std::forward<Args>(args)...);
+    num++;
+
+    return *p;
+}
+
+}  // namespace mitosim
+
+#endif  // MITOSIM_PAGED_VECTOR_H
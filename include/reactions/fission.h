@@ -39,6 +39,7 @@
 #include "utils/stochastic/reaction.h"
 
 #include "definitions.h"
+#include "tau_leaping.h"
 
 namespace mitosim {
 
@@ -49,7 +50,8 @@ class Fusion;
 /// @tparam Ntw The network class.
 template<typename Ntw>
 class Fission
-: public utils::stochastic::Reaction<RandFactory> {
+: public utils::stochastic::Reaction<RandFactory>
+, public BatchedReaction {
 
     friend utils::stochastic::Gillespie<Reaction,RandFactory>;
 
@@ -79,6 +81,15 @@ public:
     /// Executes the raction event.
     void fire() noexcept override;
 
+    /// Draws the site of an event for the current batch.
+    void draw_event() override;
+
+    /// Applies a batched event unless its segment has changed.
+    bool apply_event() override;
+
+    /// Refreshes the propensity after a batch of events.
+    void settle() override;
+
 
     /// Reports activity status of the reaction.
     /// @return True if the reaction is used in the current simulation session.
@@ -105,6 +116,9 @@ private:
 
     std::array<szt,2> cc;
 
+    /// Sites of the events drawn for the current batch.
+    std::vector<std::array<szt,2>> queued;
+
     /// Reaction name constant.
     static const std::string name;
 
@@ -190,6 +204,7 @@ update_netw_stats()
         o->update_prop(cc[0], cc[1]);
         o->set_score();
     }
+    netw.touched.clear();
 }
 
 
@@ -207,6 +222,46 @@ fire() noexcept
 }
 
 
+template<typename Ntw>
+void Fission<Ntw>::
+draw_event()
+{
+    netw.open_batch();
+    queued.push_back(netw.fis.draw());
+}
+
+
+template<typename Ntw>
+bool Fission<Ntw>::
+apply_event()
+{
+    const auto s = queued.back();
+    queued.pop_back();
+    if (netw.is_changed(s[0]))
+        return false;
+
+    if constexpr (verbose) print(true);
+
+    eventCount++;
+
+    cc = netw.fiss(s[0], s[1]);
+
+    netw.record(cc);
+
+    return true;
+}
+
+
+template<typename Ntw>
+void Fission<Ntw>::
+settle()
+{
+    netw.close_batch();
+    netw.fis.update_prop(netw.changed, netw.changedCl);
+    set_score();
+}
+
+
 template<typename Ntw>
 void Fission<Ntw>::
 print( const bool le ) const
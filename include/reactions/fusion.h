@@ -37,6 +37,7 @@
 #include "utils/stochastic/reaction.h"
 
 #include "definitions.h"
+#include "tau_leaping.h"
 
 namespace mitosim {
 
@@ -48,7 +49,8 @@ template<unsigned D1,
          unsigned D2,
          typename Ntw>
 class Fusion
-    : public utils::stochastic::Reaction<RandFactory> {
+    : public utils::stochastic::Reaction<RandFactory>
+    , public BatchedReaction {
 
     friend utils::stochastic::Gillespie<Reaction,RandFactory>;
 
@@ -150,6 +152,7 @@ update_netw_stats()
         o->update_prop(cc[0], cc[1]);
         o->set_score();
     }
+    netw.touched.clear();
 }
 
 
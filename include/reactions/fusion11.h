@@ -32,6 +32,9 @@
 #ifndef MITOSIM_FUSION11_H
 #define MITOSIM_FUSION11_H
 
+#include <array>
+#include <vector>
+
 #include "utils/stochastic/gillespie.h"
 #include "utils/stochastic/reaction.h"
 
@@ -77,6 +80,15 @@ public:
     /// Executes the raction event.
     void fire() noexcept override;
 
+    /// Draws the sites of an event for the current batch.
+    void draw_event() override;
+
+    /// Applies a batched event unless its segments have changed.
+    bool apply_event() override;
+
+    /// Refreshes the propensity after a batch of events.
+    void settle() override;
+
     /// Prints the reaction parameters.
     /// @param le True if new line after the output.
     void print(bool le) const override;
@@ -97,6 +109,9 @@ private:
     /// Total propensity for this reaction over all network components.
     szt propTotal {};
 
+    /// Sites of the events drawn for the current batch.
+    std::vector<std::array<typename Ntw::IndT,4>> queued;
+
     /// Set this reaction propensity for the whole network.
     void set_prop() noexcept override;
 };
@@ -127,7 +142,7 @@ void Fusion11<Ntw>::
 update_prop(szt /*unused*/,
             szt /*unused*/) noexcept
 {
-    set_prop();
+    propTotal = netw.fu11.update_prop(netw.touched);
 }
 
 
@@ -145,6 +160,46 @@ fire() noexcept
 }
 
 
+template<typename Ntw>
+void Fusion11<Ntw>::
+draw_event()
+{
+    netw.open_batch();
+    queued.push_back(netw.fu11.draw());
+}
+
+
+template<typename Ntw>
+bool Fusion11<Ntw>::
+apply_event()
+{
+    const auto p = queued.back();
+    queued.pop_back();
+    if (netw.is_changed(p[0]) || netw.is_changed(p[2]))
+        return false;
+
+    if constexpr (verbose) print(true);
+
+    eventCount++;
+
+    cc = netw.fuse11(p[0], p[1], p[2], p[3]);
+
+    netw.record(cc);
+
+    return true;
+}
+
+
+template<typename Ntw>
+void Fusion11<Ntw>::
+settle()
+{
+    netw.close_batch();
+    propTotal = netw.fu11.update_prop(netw.changed);
+    set_score();
+}
+
+
 template<typename Ntw>
 void Fusion11<Ntw>::
 print( const bool le ) const
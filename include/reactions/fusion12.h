@@ -32,6 +32,9 @@
 #ifndef MITOSIM_FUSION12_H
 #define MITOSIM_FUSION12_H
 
+#include <array>
+#include <vector>
+
 #include "utils/stochastic/gillespie.h"
 #include "utils/stochastic/reaction.h"
 
@@ -79,6 +82,15 @@ public:
     /// Execute the raction event.
     void fire() noexcept override;
 
+    /// Draws the sites of an event for the current batch.
+    void draw_event() override;
+
+    /// Applies a batched event unless its segments have changed.
+    bool apply_event() override;
+
+    /// Refreshes the propensity after a batch of events.
+    void settle() override;
+
     /// Prints the reaction parameters.
     /// @param le True if new line after the output.
     void print(bool le) const override;
@@ -99,6 +111,9 @@ private:
     /// Total propensity for this reaction over all network components.
     szt propTotal {};
 
+    /// Sites of the events drawn for the current batch.
+    std::vector<std::array<typename Ntw::IndT,4>> queued;
+
     /// Sets this reaction propensity for the whole network.
     void set_prop() noexcept override;
 };
@@ -128,7 +143,7 @@ template<typename Ntw>
 void Fusion12<Ntw>::
 update_prop( szt  /*unused*/, szt  /*unused*/ ) noexcept
 {
-    set_prop();
+    propTotal = netw.fu12.update_prop(netw.touched);
 }
 
 
@@ -146,6 +161,46 @@ fire() noexcept
 }
 
 
+template<typename Ntw>
+void Fusion12<Ntw>::
+draw_event()
+{
+    netw.open_batch();
+    queued.push_back(netw.fu12.draw());
+}
+
+
+template<typename Ntw>
+bool Fusion12<Ntw>::
+apply_event()
+{
+    const auto p = queued.back();
+    queued.pop_back();
+    if (netw.is_changed(p[0]) || netw.is_changed(p[2]))
+        return false;
+
+    if constexpr (verbose) print(true);
+
+    eventCount++;
+
+    cc = netw.fuse12(p[0], p[1], p[2], p[3]);
+
+    netw.record(cc);
+
+    return true;
+}
+
+
+template<typename Ntw>
+void Fusion12<Ntw>::
+settle()
+{
+    netw.close_batch();
+    propTotal = netw.fu12.update_prop(netw.changed);
+    set_score();
+}
+
+
 template<typename Ntw>
 void Fusion12<Ntw>::
 print( const bool le ) const
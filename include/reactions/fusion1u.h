@@ -30,6 +30,9 @@
 #ifndef MITOSIM_FUSION1U_H
 #define MITOSIM_FUSION1U_H
 
+#include <array>
+#include <vector>
+
 #include "utils/stochastic/gillespie.h"
 #include "utils/stochastic/reaction.h"
 
@@ -75,6 +78,15 @@ public:
     /// Executes the raction event.
     void fire() noexcept override;
 
+    /// Draws the sites of an event for the current batch.
+    void draw_event() override;
+
+    /// Applies a batched event unless its segments have changed.
+    bool apply_event() override;
+
+    /// Refreshes the propensity after a batch of events.
+    void settle() override;
+
     /// Prints the reaction parameters.
     /// @param le True if new line after the output.
     void print(bool le) const override;
@@ -95,6 +107,9 @@ private:
     /// Total propensity for this reaction over all network components.
     szt propTotal {};
 
+    /// Sites of the events drawn for the current batch.
+    std::vector<std::array<typename Ntw::IndT,3>> queued;
+
     /// Sets this reaction propensity for the whole network.
     void set_prop() noexcept override;
 };
@@ -125,7 +140,7 @@ void Fusion1U<Ntw>::
 update_prop(const szt  /*unused*/,
             const szt  /*unused*/ ) noexcept
 {
-    set_prop();
+    propTotal = netw.fu1L.update_prop(netw.touched);
 }
 
 
@@ -143,6 +158,46 @@ fire() noexcept
 }
 
 
+template<typename Ntw>
+void Fusion1U<Ntw>::
+draw_event()
+{
+    netw.open_batch();
+    queued.push_back(netw.fu1L.draw());
+}
+
+
+template<typename Ntw>
+bool Fusion1U<Ntw>::
+apply_event()
+{
+    const auto p = queued.back();
+    queued.pop_back();
+    if (netw.is_changed(p[0]) || netw.is_changed(p[2]))
+        return false;
+
+    if constexpr (verbose) print(true);
+
+    eventCount++;
+
+    cc = netw.fuse1L(p[0], p[1], p[2]);
+
+    netw.record(cc);
+
+    return true;
+}
+
+
+template<typename Ntw>
+void Fusion1U<Ntw>::
+settle()
+{
+    netw.close_batch();
+    propTotal = netw.fu1L.update_prop(netw.changed);
+    set_score();
+}
+
+
 template<typename Ntw>
 void Fusion1U<Ntw>::
 print( const bool le ) const
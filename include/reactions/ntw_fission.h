@@ -32,10 +32,13 @@
 #ifndef MITOSIM_NTW_FISSION_H
 #define MITOSIM_NTW_FISSION_H
 
+#include <algorithm>
 #include <array>
+#include <numeric>
 #include <vector>
 
 #include "definitions.h"
+#include "fenwick_tree.h"
 
 namespace mitosim {
 
@@ -43,14 +46,21 @@ template<typename> class Fission;
 
 /**
  * Base class for network-specific fission reaction slots.
+ * @details Unless heterogeneous_fission is set, the fission weights are
+ * homogeneous and follow from segment lengths and end degrees alone, so that
+ * the sites are sampled per segment without touching the edges. Otherwise,
+ * the edge end factors stored in Segment::fin are used.
  * @tparam Ntw Type of the network.
  */
 template<typename Ntw>
 class NtwFission {
 
+    static_assert(!(Ntw::ST::coarse && heterogeneous_fission),
+                  "Segments without edges support only homogeneous fission");
+
 public:
 
-    using Prop = typename Ntw::ST::EdgeT::FinT;
+    using Prop = typename Ntw::ST::FinT;
 
     friend Fission<Ntw>;
 
@@ -66,9 +76,26 @@ public:
      */
     void update_prop(szt c) noexcept;
 
+    /**
+     * @brief Update this reaction propensity after a batch of events.
+     * @param touched Indexes of the segments changed by the events.
+     * @param cls Indexes of the clusters changed by the events.
+     */
+    void update_prop(const std::vector<szt>& touched,
+                     const std::vector<szt>& cls) noexcept;
+
     /// prTotal getter.
     constexpr auto get_prTotal() const noexcept { return prTotal; }
 
+    /// pr getter.
+    constexpr const auto& get_pr() const noexcept { return pr; }
+
+    /**
+     * @brief Draws a fission site, without executing the fission.
+     * @return Segment index and in-segment position of the node.
+     */
+    auto draw() const noexcept -> std::array<szt,2>;
+
 private:
 
     Ntw& host;  ///< ref: The host network for this reaction.
@@ -81,6 +108,19 @@ private:
     std::vector<Prop> pr;   ///< Propensities per cluster.
     Prop prTotal {};  ///< Total propensity.
 
+    /// Fission weights of the edges indexed network-wide.
+    FenwickTree<Prop> sites;
+    /// Fission weights of the segments in the homogeneous mode.
+    FenwickTree<Prop> segs;
+
+    /**
+     * @brief Fission weight of a segment in the homogeneous mode.
+     * @details A connected end contributes once, and each of the internal
+     * nodes twice, once for every edge end it joins.
+     * @param m The segment.
+     */
+    static Prop weight(const typename Ntw::ST& m) noexcept;
+
     /**
      * Set this reaction propensity for the indexed cluster.
      * @note Does not update the whole network propensity.
@@ -93,6 +133,8 @@ private:
 
     /**
      * @brief Finds sa random node from those suitable for this reaction.
+     * @details The segment, or the edge, is found by inverse cumulative
+     * distribution lookup over the weights, then the node inside it.
      * @param w Index of random segment.
      * @param a Random position inside the segment.
      */
@@ -113,11 +155,17 @@ template<typename Ntw>
 auto NtwFission<Ntw>::
 set_prop() noexcept -> Prop
 {
+    if constexpr (heterogeneous_fission)
+        sites.reset(host.mtmass);
+    else
+        segs.reset(host.mtmass + 1);
     pr.resize(clnum);
     for (szt ic=0; ic<clnum; ic++)
         set_prop(ic);
 
-    return std::accumulate(pr.begin(), pr.end(), zero<Prop>);
+    prTotal = std::accumulate(pr.begin(), pr.end(), zero<Prop>);
+
+    return prTotal;
 }
 
 template<typename Ntw>
@@ -125,12 +173,23 @@ void NtwFission<Ntw>::
 set_prop( const szt ic ) noexcept
 {
     pr[ic] = zero<Prop>;
-    for (const auto w : host.clmt[ic]) {
-        pr[ic] += mt[w].template set_end_fin<1>() +
-                  mt[w].template set_end_fin<2>();
-        for (szt a=0; a<mt[w].g.size()-1; a++)
-            pr[ic] += 2UL * mt[w].set_bulk_fin(a);
+
+    if constexpr (!heterogeneous_fission) {
+        for (const auto w : host.clmt[ic]) {
+            const auto f = weight(mt[w]);
+            segs.set(w, f);
+            pr[ic] += f;
+        }
     }
+    else
+        for (const auto w : host.clmt[ic]) {
+            auto& m = mt[w];
+            pr[ic] += m.set_fins();
+            // The factors are read as dense columns parallel to the edges.
+            const auto& [f0, f1] = m.fin;
+            for (szt k=0; k<m.length(); k++)
+                sites.set(m.g[k].get_ind(), f0[k] + f1[k]);
+        }
 }
 
 template<typename Ntw>
@@ -144,22 +203,67 @@ update_prop( const szt c ) noexcept
     else if (pr.size() < clnum)
         pr.resize(clnum);
 
+    // Segments renamed or removed by the transformation may belong
+    // to other clusters or to none.
+    if constexpr (!heterogeneous_fission)
+        for (const auto w : host.touched)
+            segs.set(w, w <= host.mtnum ? weight(mt[w]) : zero<Prop>);
+
     if (c < clnum)
         set_prop(c);
 
     prTotal = std::accumulate(pr.begin(), pr.end(), zero<Prop>);
 }
 
+template<typename Ntw>
+void NtwFission<Ntw>::
+update_prop(
+    const std::vector<szt>& touched,
+    const std::vector<szt>& cls
+) noexcept
+{
+    pr.resize(clnum);
+
+    if constexpr (!heterogeneous_fission)
+        for (const auto w : touched)
+            segs.set(w, w <= host.mtnum ? weight(mt[w]) : zero<Prop>);
+
+    // Clusters that vanished in the batch have left the indexes past 'clnum'.
+    for (const auto c : cls)
+        if (c < clnum)
+            set_prop(c);
+
+    prTotal = std::accumulate(pr.begin(), pr.end(), zero<Prop>);
+}
+
+template<typename Ntw>
+auto NtwFission<Ntw>::
+weight( const typename Ntw::ST& m ) noexcept -> Prop
+{
+    return static_cast<Prop>((m.nn[1] ? 1UL : 0UL) +
+                             (m.nn[2] ? 1UL : 0UL) +
+                             2UL * (m.length() - 1));
+}
+
 template<typename Ntw>
 auto NtwFission<Ntw>::
 fire() noexcept
+{
+    const auto s = draw();
+
+    return host.fiss(s[0], s[1]);
+}
+
+template<typename Ntw>
+auto NtwFission<Ntw>::
+draw() const noexcept -> std::array<szt,2>
 {
     auto w = undefined<szt>;
     auto a = undefined<szt>;
 
     find_random_node(w, a);
 
-    return host.fiss(w, a);
+    return {w, a};
 }
 
 template<typename Ntw>
@@ -167,27 +271,32 @@ bool NtwFission<Ntw>::
 find_random_node( szt& w, szt& a ) const noexcept
 {
     auto k = host.rnd.uniform0(prTotal);
-    typename Ntw::ST::EdgeT::FinT ksum {};
-    for (w=1; w<=host.mtnum; w++) {
-        const auto& g = mt[w].g;
-        a = 0;
-        ksum += g[a].get_fin(0);
-        if (k <= ksum)
-            return true;
-        for (; a<g.size()-1;) {
-            ksum += g[a].get_fin(1);
-            a++;
-            ksum += g[a].get_fin(0);
-            if (k <= ksum)
+
+    if constexpr (!heterogeneous_fission) {
+        w = segs.find(k, k);
+        const auto& m = mt[w];
+        if (m.nn[1]) {
+            if (k < one<Prop>) {          // the node at end 1
+                a = 0;
                 return true;
+            }
+            k -= one<Prop>;
         }
-        ksum += g[a].get_fin(1);
-        if (k <= ksum) {
+        const auto bulk = m.length() - 1;
+        a = k < static_cast<Prop>(2 * bulk)
+          ? std::min(static_cast<szt>(k / 2) + 1, bulk)
+          : m.length();                   // the node at end 2
+    }
+    else {
+        const auto ind = sites.find(k, k);
+
+        w = host.glm[ind];
+        a = mt[w].pos(host.gla[ind]);
+        if (k >= mt[w].get_fin(a, 0))    // the node at the edge end 2
             a++;
-            return true;
-        }
     }
-    return false;
+
+    return true;
 }
 
 }  // namespace mitosim
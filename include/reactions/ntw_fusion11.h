@@ -33,6 +33,7 @@
 #define MITOSIM_NTW_FUSION11_H
 
 #include <array>
+#include <memory_resource>
 #include <vector>
 
 #include "definitions.h"
@@ -44,72 +45,146 @@ template<typename> class Fusion11;
 
 /**
  * Network-specific reaction slot for fusion of two nodes of degree 1.
+ * @details In the implicit mode the candidate pairs are counted in closed
+ * form from the free end registry, and fire() unranks a random pair index
+ * directly into the participating ends. The registry is updated for the
+ * touched segments only, so that an event costs O(1) per touched segment.
  * @tparam Ntw Type of the network.
+ * @tparam Implicit Sample from node counts rather than from candidate lists.
  */
-template<typename Ntw>
+template<typename Ntw,
+         bool Implicit=false>
 class NtwFusion11 {
 
 public:
 
     friend Fusion11<Ntw>;
 
-    explicit NtwFusion11(Ntw&);  ///< Constructor.
+    using Ind = typename Ntw::IndT;  ///< Index type of the network tables.
+
+    /**
+     * @brief Constructor.
+     * @param host The host network.
+     * @param mr Memory resource for the candidate buffers.
+     */
+    explicit NtwFusion11(
+        Ntw& host,
+        std::pmr::memory_resource* mr=std::pmr::get_default_resource()
+    );
 
     /// Sets this reaction propensity for the whole network.
     auto set_prop() noexcept -> szt;
 
-    const FusionCandidatesXX& get_cnd() { return cnd; }
+    /**
+     * @brief Updates this reaction propensity after a network transformation.
+     * @details Only the node pairs involving the segments touched by the
+     * transformation are renewed.
+     * @param touched Indexes of the touched segments.
+     */
+    auto update_prop(const std::vector<szt>& touched) noexcept -> szt;
+
+    const FusionCandidatesXX<Ind>& get_cnd() { return cnd; }
+
+    /**
+     * @brief Draws a node pair for the fusion, without executing it.
+     * @return Segment and end indexes of the two participants.
+     */
+    auto draw() noexcept -> std::array<Ind,4>;
 
 private:
 
+    static constexpr auto minLL = Structure<typename Ntw::ST>::minLoopLength;
+
     Ntw& host;  ///< ref: the host network for this reaction.
 
     // Convenience references to some of the host members.
     RandFactory& rnd;
-    const std::vector<szt>&               mt11;
-    const std::vector<std::array<szt,2>>& mt13;
+    const std::vector<Ind>&                   mt11;
+    const std::vector<typename Ntw::SegEnd>& mt13;
 
     /// Node pairs suitable for this type of fusion.
-    FusionCandidatesXX cnd;
+    FusionCandidatesXX<Ind> cnd;
+
+    // Implicit mode:
+    FreeEnds<Ind> ends;  ///< Free end registry.
+    /// Number of pairs by kind: loop closures, 11-11, 11-13 and 13-13.
+    std::array<szt,4> num {};
 
     /// Populates the vector of node pairs suitable for this type of fusion.
     void populate() noexcept;
 
+    /**
+     * @brief Adds the node pairs involving a segment.
+     * @param w1 Segment index.
+     * @param renewed Tells if a segment gets its pairs renewed as well.
+     */
+    template<typename R>
+    void add_pairs(Ind w1, const R& renewed) noexcept;
+
+    /// Counts the node pairs suitable for this type of fusion.
+    auto count() noexcept -> szt;
+
     /// Executes the raction event.
     auto fire() noexcept;
 };
 // IMPLEMENTATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-template<typename Ntw>
-NtwFusion11<Ntw>::
-NtwFusion11( Ntw& host )
+template<typename Ntw, bool Implicit>
+NtwFusion11<Ntw,Implicit>::
+NtwFusion11(
+        Ntw& host,
+        std::pmr::memory_resource* mr
+    )
     : host {host}
     , rnd {host.rnd}
     , mt11 {host.mt11}
     , mt13 {host.mt13}
+    , cnd {mr}
+    , ends {host.mt11, host.mt13}
 {}
 
-template<typename Ntw>
-auto NtwFusion11<Ntw>::
+template<typename Ntw, bool Implicit>
+auto NtwFusion11<Ntw,Implicit>::
 set_prop() noexcept -> szt
 {
-     populate();
-     return cnd.size();
+    if constexpr (Implicit) {
+        ends.reset(host.mt, host.mtnum, minLL);
+        return count();
+    }
+
+    populate();
+    return cnd.size();
 }
 
-template<typename Ntw>
-void NtwFusion11<Ntw>::
+template<typename Ntw, bool Implicit>
+auto NtwFusion11<Ntw,Implicit>::
+update_prop( const std::vector<szt>& touched ) noexcept -> szt
+{
+    if constexpr (Implicit) {
+        for (const auto w : touched)
+            ends.update(host.mt, host.mtnum, w, minLL);
+        return count();
+    }
+
+    cnd.renew(touched, host.mtnum,
+              [this](const szt w, const auto& renewed) {
+                  add_pairs(w, renewed);
+              });
+    return cnd.size();
+}
+
+template<typename Ntw, bool Implicit>
+void NtwFusion11<Ntw,Implicit>::
 populate() noexcept
 {
-    constexpr auto minLL = Structure<typename Ntw::ST>::minLoopLength;
-    constexpr std::array<szt,2> a12 {1UL, 2UL};
+    constexpr std::array<Ind,2> a12 {1, 2};
 
     cnd.clear();
     const auto mtn11 = mt11.size();
     for (szt i1=0; i1<mtn11; i1++) {        // 11 ends to ...
         const auto w1 = mt11[i1];
 
-        if (host.mt[w1].g.size() >= minLL)  // ... same segment opposite end
+        if (host.mt[w1].length() >= minLL)  // ... same segment opposite end
             cnd.add({w1,1}, {w1,2});
 
         for (const auto e1 : a12) {
@@ -129,14 +204,83 @@ populate() noexcept
             cnd.add(mt13[i1], mt13[i2]);
 }
 
-template<typename Ntw>
-auto NtwFusion11<Ntw>::
+template<typename Ntw, bool Implicit>
+template<typename R>
+void NtwFusion11<Ntw,Implicit>::
+add_pairs( const Ind w1, const R& renewed ) noexcept
+{
+    const auto fe = FreeEnds<Ind>::of(host.mt[w1]);
+
+    if (fe[0] == 2 && host.mt[w1].length() >= minLL)  // same segment opposite end
+        cnd.add({w1,1}, {w1,2});
+
+    for (szt i=1; i<=fe[0]; i++)                // free ends of w1 to ...
+        for (szt k=0; k<ends.size(); k++) {     // ... free ends of other segs.
+            const auto we2 = ends[k];           //     (once per renewed pair)
+            if (we2[0] != w1 && (we2[0] > w1 || !renewed(we2[0])))
+                cnd.add({w1, fe[i]}, we2);
+        }
+}
+
+template<typename Ntw, bool Implicit>
+auto NtwFusion11<Ntw,Implicit>::
+count() noexcept -> szt
+{
+    const auto n11 = ends.num11();
+    const auto n13 = ends.num13();
+
+    num[0] = ends.get_loopable().size();    // same segment opposite end
+    num[1] = 4 * (n11 * (n11 - 1) / 2);     // 11 ends to other 11 ends
+    num[2] = 2 * n11 * n13;                 // 11 ends to 13 free ends
+    num[3] = n13 * (n13 - 1) / 2;           // 13 free ends to each other
+
+    return num[0] + num[1] + num[2] + num[3];
+}
+
+template<typename Ntw, bool Implicit>
+auto NtwFusion11<Ntw,Implicit>::
 fire() noexcept
 {
-    const auto r = rnd.uniform0(cnd.size());
+    const auto p = draw();
+
+    return host.fuse11(p[0], p[1], p[2], p[3]);
+}
+
+template<typename Ntw, bool Implicit>
+auto NtwFusion11<Ntw,Implicit>::
+draw() noexcept -> std::array<Ind,4>
+{
+    if constexpr (!Implicit) {
+        const auto& c = cnd[rnd.uniform0(cnd.size())];
+
+        return {c.u[0], c.u[1], c.v[0], c.v[1]};
+    }
+
+    auto r = rnd.uniform0(num[0] + num[1] + num[2] + num[3]);
+
+    if (r < num[0]) {
+        const auto w = ends.get_loopable()[r];
+        return {w, 1, w, 2};
+    }
+    r -= num[0];
+
+    if (r < num[1]) {
+        const auto p = FreeEnds<Ind>::unrank_pair(r / 4);
+        return {mt11[p[0]], static_cast<Ind>(r % 4 / 2 + 1),
+                mt11[p[1]], static_cast<Ind>(r % 2 + 1)};
+    }
+    r -= num[1];
+
+    if (r < num[2]) {
+        const auto we1 = ends[r / ends.num13()];
+        const auto& we2 = mt13[r % ends.num13()];
+        return {we1[0], we1[1], we2[0], we2[1]};
+    }
+    r -= num[2];
 
-    return host.fuse11(cnd.u[r][0], cnd.u[r][1],
-                       cnd.v[r][0], cnd.v[r][1]);
+    const auto p = FreeEnds<Ind>::unrank_pair(r);
+    return {mt13[p[0]][0], mt13[p[0]][1],
+            mt13[p[1]][0], mt13[p[1]][1]};
 }
 
 }  // namespace mitosim
@@ -32,9 +32,12 @@
 #ifndef MITOSIM_NTW_FUSION12_H
 #define MITOSIM_NTW_FUSION12_H
 
+#include <algorithm>
 #include <array>
+#include <memory_resource>
 #include <vector>
 
+#include "../fenwick_tree.h"
 #include "../fusion_candidates.h"
 #include "definitions.h"
 
@@ -46,49 +49,122 @@ template<typename> class Fusion12;
  * Reaction slot for fusion of a degree 1 node with a degree 2 node,
  * Network-specific reaction slot for fusion of a degree 1 node
  * with a degree 2 node.
+ * @details In the implicit mode the candidate pairs are not materialized:
+ * the propensity follows from the number of free ends and of the bulk nodes,
+ * and the pair is drawn in two stages: first the free end, then the bulk node.
+ * The bulk nodes are kept per segment and updated for the touched segments
+ * only, so that an event costs O(log mtnum) irrespective of the network size.
  * @tparam Ntw Type of the network.
+ * @tparam Implicit Sample from node counts rather than from candidate lists.
  */
-template<typename Ntw>
+template<typename Ntw,
+         bool Implicit=false>
 class NtwFusion12 {
 
 public:
 
     friend Fusion12<Ntw>;
 
-    explicit NtwFusion12(Ntw&); ///< Constructor.
+    using Ind = typename Ntw::IndT;  ///< Index type of the network tables.
+
+    /**
+     * @brief Constructor.
+     * @param host The host network.
+     * @param mr Memory resource for the candidate buffers.
+     */
+    explicit NtwFusion12(
+        Ntw& host,
+        std::pmr::memory_resource* mr=std::pmr::get_default_resource()
+    );
 
     /// Sets this reaction propensity for the whole network.
     auto set_prop() noexcept -> szt;
 
-    const FusionCandidatesXX& get_cnd() { return cnd; }
+    /**
+     * @brief Updates this reaction propensity after a network transformation.
+     * @details Only the node pairs involving the segments touched by the
+     * transformation are renewed.
+     * @param touched Indexes of the touched segments.
+     */
+    auto update_prop(const std::vector<szt>& touched) noexcept -> szt;
+
+    const FusionCandidatesXX<Ind>& get_cnd() { return cnd; }
+
+    /**
+     * @brief Draws a node pair for the fusion, without executing it.
+     * @return Segment and end of the free end, segment and position of the
+     * bulk node.
+     */
+    auto draw() noexcept -> std::array<Ind,4>;
 
 private:
 
+    static constexpr auto minLL = Structure<typename Ntw::ST>::minLoopLength;
+
     Ntw& host;  ///< ref: the host network for this reaction.
     
     // Convenience references to some of the host members.
     RandFactory& rnd;
 
-    const typename Ntw::Reticulum&        mt;
-    const std::vector<szt>&               mt11;
-    const std::vector<std::array<szt,2>>& mt13;
-    const std::vector<szt>&               mt22;
-    const std::vector<szt>&               mt33;
+    const typename Ntw::Reticulum&           mt;
+    const std::vector<Ind>&                   mt11;
+    const std::vector<typename Ntw::SegEnd>& mt13;
+    const std::vector<Ind>&                   mt22;
+    const std::vector<Ind>&                   mt33;
+
+    FusionCandidatesXX<Ind> cnd;  ///< Node pairs suitable for this type of fusion.
 
-    FusionCandidatesXX cnd;  ///< Node pairs suitable for this type of fusion.
+    // Implicit mode:
+    FreeEnds<Ind> ends;  ///< Free end registry.
+    /// Bulk nodes of the segments, indexed by segment.
+    FenwickTree<szt> bulk;
+    /// Bulk nodes of own segment barred to the free ends, by segment.
+    std::vector<szt> barredOf;
+    szt barred {};  ///< Total of 'barredOf'.
 
     /// Populates the vector of node pairs suitable for this type of fusion.
     void populate() noexcept;
 
+    /**
+     * @brief Adds the node pairs involving a segment.
+     * @param w Segment index.
+     * @param renewed Tells if a segment gets its pairs renewed as well.
+     */
+    template<typename R>
+    void add_pairs(Ind w, const R& renewed) noexcept;
+
+    /// Counts the free ends and the bulk nodes anew.
+    auto count() noexcept -> szt;
+
+    /**
+     * @brief Updates the counts for a segment changed by a transformation.
+     * @param w Segment index, possibly of a segment removed.
+     */
+    void recount(szt w) noexcept;
+
+    /// Number of the node pairs given the current counts.
+    auto num_pairs() const noexcept -> szt;
+
+    /**
+     * @brief Number of bulk nodes of own segment unavailable to a free end.
+     * @details These are the nodes that are too close to the end to bend the
+     * segment into a loop shorter than minLoopLength.
+     * @param w Segment index.
+     */
+    auto num_barred(szt w) const noexcept -> szt;
+
     /// Executes the raction event.
     auto fire() noexcept;
 };
 
 // IMPLEMENTATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-template<typename Ntw>
-NtwFusion12<Ntw>::
-NtwFusion12( Ntw& host )
+template<typename Ntw, bool Implicit>
+NtwFusion12<Ntw,Implicit>::
+NtwFusion12(
+        Ntw& host,
+        std::pmr::memory_resource* mr
+    )
     : host {host}
     , rnd {host.rnd}
     , mt {host.mt}
@@ -96,80 +172,213 @@ NtwFusion12( Ntw& host )
     , mt13 {host.mt13}
     , mt22 {host.mt22}
     , mt33 {host.mt33}
+    , cnd {mr}
+    , ends {host.mt11, host.mt13}
 {}
 
-template<typename Ntw>
-auto NtwFusion12<Ntw>::
+template<typename Ntw, bool Implicit>
+auto NtwFusion12<Ntw,Implicit>::
 set_prop() noexcept -> szt
 {
-     populate();
-     return cnd.size();
+    if constexpr (Implicit)
+        return count();
+
+    populate();
+    return cnd.size();
+}
+
+template<typename Ntw, bool Implicit>
+auto NtwFusion12<Ntw,Implicit>::
+update_prop( const std::vector<szt>& touched ) noexcept -> szt
+{
+    if constexpr (Implicit) {
+        for (const auto w : touched)
+            if (w >= bulk.size())
+                return count();
+        for (const auto w : touched)
+            recount(w);
+        return num_pairs();
+    }
+
+    cnd.renew(touched, host.mtnum,
+              [this](const szt w, const auto& renewed) {
+                  add_pairs(w, renewed);
+              });
+    return cnd.size();
 }
 
-template<typename Ntw>
-void NtwFusion12<Ntw>::
+template<typename Ntw, bool Implicit>
+void NtwFusion12<Ntw,Implicit>::
 populate() noexcept
 {
-    constexpr auto minLL = Structure<typename Ntw::ST>::minLoopLength;
-    constexpr std::array<szt,2> a12 {1UL, 2UL};
+    constexpr std::array<Ind,2> a12 {1, 2};
 
     cnd.clear();
     for (const auto w1 : mt11)                           // 11 ends to ...
         for (const auto e1 : a12) {
-            const std::array<szt,2> we1 {w1,e1};
+            const std::array<Ind,2> we1 {w1,e1};
             for (const auto w2 : mt11)                   // ... 11 bulk
-                for (szt i=1; i<mt[w2].g.size(); i++) {
+                for (Ind i=1; i<mt[w2].length(); i++) {
                     const auto skip = w1 == w2 && (
                                     (e1 == 1 && i < minLL) ||
-                                    (e1 == 2 && mt[w2].g.size()-i < minLL));
+                                    (e1 == 2 && mt[w2].length()-i < minLL));
                     if (!skip)
                         cnd.add(we1, {w2,i});
                 }
             for (const auto& we2 : mt13)                 // ... 13 bulk
-                for (szt i=1; i<mt[we2[0]].g.size(); i++)
+                for (Ind i=1; i<mt[we2[0]].length(); i++)
                     cnd.add(we1, {we2[0],i});
 
             for (const auto w2 : mt33)                    // ... 33 bulk
-                for (szt i=1; i<mt[w2].g.size(); i++)
+                for (Ind i=1; i<mt[w2].length(); i++)
                     cnd.add(we1, {w2,i});
 
             for (const auto w2 : mt22)                    // ... 22 bulk
-                for (szt i=1; i<mt[w2].g.size(); i++)
+                for (Ind i=1; i<mt[w2].length(); i++)
                     cnd.add(we1, {w2,i});
         }
 
     for (const auto& we1 : mt13) {                        // a free end of 13 to ...
         for (const auto w2 : mt11)                        // ... 11 bulk
-            for (szt i=1; i<mt[w2].g.size(); i++)
+            for (Ind i=1; i<mt[w2].length(); i++)
                 cnd.add(we1, {w2,i});
 
         for (const auto& we2 : mt13) {                    // ... 13 bulk
-            for (szt i=1; i<mt[we2[0]].g.size(); i++) {
+            for (Ind i=1; i<mt[we2[0]].length(); i++) {
                 const auto skip = we1[0] == we2[0] &&
                                  ((we1[1] == 1 && i < minLL) ||
-                                  (we1[1] == 2 && mt[we2[0]].g.size()-i < minLL));
+                                  (we1[1] == 2 && mt[we2[0]].length()-i < minLL));
                 if (!skip)
                     cnd.add(we1, {we2[0],i});
             }
         }
         for (const auto w2 : mt33)                       // ... 33 bulk
-            for (szt i=1; i<mt[w2].g.size(); i++)
+            for (Ind i=1; i<mt[w2].length(); i++)
                 cnd.add(we1, {w2,i});
 
         for (const auto w2 : mt22)                       // ... 22 bulk
-            for (szt i=1; i<mt[w2].g.size(); i++)
+            for (Ind i=1; i<mt[w2].length(); i++)
                 cnd.add(we1, {w2,i});
     }
 }
 
-template<typename Ntw>
-auto NtwFusion12<Ntw>::
+template<typename Ntw, bool Implicit>
+template<typename R>
+void NtwFusion12<Ntw,Implicit>::
+add_pairs( const Ind w, const R& renewed ) noexcept
+{
+    const auto fe = FreeEnds<Ind>::of(mt[w]);
+    const auto len = mt[w].length();
+
+    for (szt j=1; j<=fe[0]; j++) {                      // free ends of w to ...
+        const std::array<Ind,2> we1 {w, fe[j]};
+        const auto add_bulk = [&](const Ind w2) {
+            for (Ind i=1; i<mt[w2].length(); i++) {
+                const auto skip = w2 == w && (
+                                (fe[j] == 1 && i < minLL) ||
+                                (fe[j] == 2 && len-i < minLL));
+                if (!skip)
+                    cnd.add(we1, {w2,i});
+            }
+        };
+        for (const auto w2 : mt11) add_bulk(w2);        // ... 11 bulk
+        for (const auto& we2 : mt13) add_bulk(we2[0]);  // ... 13 bulk
+        for (const auto w2 : mt33) add_bulk(w2);        // ... 33 bulk
+        for (const auto w2 : mt22) add_bulk(w2);        // ... 22 bulk
+    }
+
+    for (szt k=0; k<ends.size(); k++) {     // free ends of other segs. to w bulk
+        const auto we1 = ends[k];
+        if (we1[0] != w && !renewed(we1[0]))
+            for (Ind i=1; i<len; i++)
+                cnd.add(we1, {w,i});
+    }
+}
+
+template<typename Ntw, bool Implicit>
+auto NtwFusion12<Ntw,Implicit>::
+count() noexcept -> szt
+{
+    // Every segment has at least one edge, so that the mass bounds
+    // the segment indexes.
+    bulk.reset(std::max(host.mtmass, host.mtnum) + 1);
+    barredOf.assign(bulk.size(), 0);
+    barred = 0;
+    for (szt w=1; w<=host.mtnum; w++)
+        recount(w);
+
+    return num_pairs();
+}
+
+template<typename Ntw, bool Implicit>
+void NtwFusion12<Ntw,Implicit>::
+recount( const szt w ) noexcept
+{
+    // Segments renamed or removed by the transformation count as empty.
+    const auto present = w && w <= host.mtnum;
+    bulk.set(w, present ? mt[w].length() - 1 : 0);
+
+    const auto b = present ? FreeEnds<Ind>::of(mt[w])[0] * num_barred(w) : 0;
+    barred += b;
+    barred -= barredOf[w];
+    barredOf[w] = b;
+}
+
+template<typename Ntw, bool Implicit>
+auto NtwFusion12<Ntw,Implicit>::
+num_pairs() const noexcept -> szt
+{
+    // Every free end pairs with every bulk node except the barred ones.
+    return ends.size() * bulk.total() - barred;
+}
+
+template<typename Ntw, bool Implicit>
+auto NtwFusion12<Ntw,Implicit>::
+num_barred( const szt w ) const noexcept -> szt
+{
+    return std::min(minLL - 1, mt[w].length() - 1);
+}
+
+template<typename Ntw, bool Implicit>
+auto NtwFusion12<Ntw,Implicit>::
 fire() noexcept
 {
-    const auto r = rnd.uniform0(cnd.size());
+    const auto p = draw();
+
+    return host.fuse12(p[0], p[1], p[2], p[3]);
+}
+
+template<typename Ntw, bool Implicit>
+auto NtwFusion12<Ntw,Implicit>::
+draw() noexcept -> std::array<Ind,4>
+{
+    if constexpr (!Implicit) {
+        const auto& c = cnd[rnd.uniform0(cnd.size())];
+
+        return {c.u[0], c.u[1], c.v[0], c.v[1]};
+    }
 
-    return host.fuse12(cnd.u[r][0], cnd.u[r][1],
-                       cnd.v[r][0], cnd.v[r][1]);
+    // Stage 1: the free end, chosen in proportion to the number of bulk
+    // nodes available to it. Uniform choice is thinned by the barred ones.
+    const auto numBulk = bulk.total();
+    std::array<Ind,2> we1;
+    szt x;
+    do {
+        we1 = ends[rnd.uniform0(ends.size())];
+        x = num_barred(we1[0]);
+    } while (rnd.uniform0(numBulk) < x);
+
+    // Stage 2: the bulk node, uniformly among those allowed for this end.
+    auto r = rnd.uniform0(numBulk - x);
+    const auto firstBarred = we1[1] == 1 ? bulk.prefix(we1[0])
+                                         : bulk.prefix(we1[0] + 1) - x;
+    if (r >= firstBarred)
+        r += x;
+
+    szt i;
+    const auto w2 = bulk.find(r, i);
+
+    return {we1[0], we1[1], static_cast<Ind>(w2), static_cast<Ind>(i + 1)};
 }
 
 }  // namespace mitosim
@@ -33,6 +33,7 @@
 #define MITOSIM_NTW_FUSION1U_H
 
 #include <array>
+#include <memory_resource>
 #include <vector>
 
 #include "../fusion_candidates.h"
@@ -45,67 +46,127 @@ template<typename> class Fusion1U;
 /**
  * Reaction slot for fusion of a degree 1 node with a looped segment.
  * @details Network-specific reaction slot for fusion of a degree 1 node with
- * a looped segment.
+ * a looped segment. All such pairs are valid and equally weighted, so in the
+ * implicit mode the propensity is the product of the number of free ends and
+ * the number of cycles, which are drawn independently.
  * @tparam Ntw Type of the network.
+ * @tparam Implicit Sample from node counts rather than from candidate lists.
  */
-template<typename Ntw>
+template<typename Ntw,
+         bool Implicit=false>
 class NtwFusion1U {
 
     friend Fusion1U<Ntw>;
 
 public:
 
-    explicit NtwFusion1U(Ntw&);  ///< The only constructor.
+    using Ind = typename Ntw::IndT;  ///< Index type of the network tables.
+
+    /**
+     * @brief The only constructor.
+     * @param host The host network.
+     * @param mr Memory resource for the candidate buffers.
+     */
+    explicit NtwFusion1U(
+        Ntw& host,
+        std::pmr::memory_resource* mr=std::pmr::get_default_resource()
+    );
 
     /// Sets this reaction propensity for the whole network.
     auto set_prop() noexcept -> szt;
 
-    const FusionCandidatesXU& get_cnd() { return cnd; }
+    /**
+     * @brief Updates this reaction propensity after a network transformation.
+     * @details Only the node pairs involving the segments touched by the
+     * transformation are renewed.
+     * @param touched Indexes of the touched segments.
+     */
+    auto update_prop(const std::vector<szt>& touched) noexcept -> szt;
+
+    const FusionCandidatesXU<Ind>& get_cnd() { return cnd; }
+
+    /**
+     * @brief Draws a free end and a cycle for the fusion, without executing it.
+     * @return Segment and end indexes of the free end, and the cycle index.
+     */
+    auto draw() noexcept -> std::array<Ind,3>;
 
 private:
 
     Ntw& host;  ///< ref: the host network for this reaction.
 
     // Convenience references to some of the host members.
-    RandFactory&                          rnd;
-    const std::vector<szt>&               mt11;
-    const std::vector<std::array<szt,2>>& mt13;
-    const std::vector<szt>&               mt22;
+    RandFactory&                             rnd;
+    const std::vector<Ind>&                   mt11;
+    const std::vector<typename Ntw::SegEnd>& mt13;
+    const std::vector<Ind>&                   mt22;
 
-    FusionCandidatesXU cnd; ///< Node pairs suitable for this type of fusion.
+    FusionCandidatesXU<Ind> cnd; ///< Node pairs suitable for this type of fusion.
+
+    FreeEnds<Ind> ends;  ///< Free end registry used in the implicit mode.
 
     /// Populates the vector of node pairs suitable for this type of fusion.
     void populate() noexcept;
 
+    /**
+     * @brief Adds the node pairs involving a segment.
+     * @param w Segment index.
+     * @param renewed Tells if a segment gets its pairs renewed as well.
+     */
+    template<typename R>
+    void add_pairs(Ind w, const R& renewed) noexcept;
+
     /// Executes the reaction event.
     auto fire() noexcept;
 };
 
 // IMPLEMENTATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-template<typename Ntw>
-NtwFusion1U<Ntw>::
-NtwFusion1U( Ntw& host )
+template<typename Ntw, bool Implicit>
+NtwFusion1U<Ntw,Implicit>::
+NtwFusion1U(
+        Ntw& host,
+        std::pmr::memory_resource* mr
+    )
     : host {host}
     , rnd {host.rnd}
     , mt11 {host.mt11}
     , mt13 {host.mt13}
     , mt22 {host.mt22}
+    , cnd {mr}
+    , ends {host.mt11, host.mt13}
 {}
 
-template<typename Ntw>
-auto NtwFusion1U<Ntw>::
+template<typename Ntw, bool Implicit>
+auto NtwFusion1U<Ntw,Implicit>::
 set_prop() noexcept -> szt
 {
-     populate();
-     return cnd.size();
+    if constexpr (Implicit)
+        return ends.size() * mt22.size();
+
+    populate();
+    return cnd.size();
 }
 
-template<typename Ntw>
-void NtwFusion1U<Ntw>::
+template<typename Ntw, bool Implicit>
+auto NtwFusion1U<Ntw,Implicit>::
+update_prop( const std::vector<szt>& touched ) noexcept -> szt
+{
+    if constexpr (Implicit)
+        return set_prop();
+
+    cnd.renew(touched, host.mtnum,
+              [this](const szt w, const auto& renewed) {
+                  add_pairs(w, renewed);
+              });
+    return cnd.size();
+}
+
+template<typename Ntw, bool Implicit>
+void NtwFusion1U<Ntw,Implicit>::
 populate() noexcept
 {
-    constexpr std::array<szt,2> a12 {1UL, 2UL};
+    constexpr std::array<Ind,2> a12 {1, 2};
 
     cnd.clear();
     for (const auto w2 : mt22) {
@@ -118,14 +179,48 @@ populate() noexcept
     }
 }
 
-template<typename Ntw>
-auto NtwFusion1U<Ntw>::
+template<typename Ntw, bool Implicit>
+template<typename R>
+void NtwFusion1U<Ntw,Implicit>::
+add_pairs( const Ind w, const R& renewed ) noexcept
+{
+    const auto& m = host.mt[w];
+    const auto fe = FreeEnds<Ind>::of(m);
+
+    for (szt j=1; j<=fe[0]; j++)            // free ends of w to the cycles
+        for (const auto w2 : mt22)
+            cnd.add({w, fe[j]}, w2);
+
+    if (!fe[0] && m.is_cycle())             // w as a cycle to the free ends
+        for (szt k=0; k<ends.size(); k++) {
+            const auto we1 = ends[k];
+            if (!renewed(we1[0]))
+                cnd.add(we1, w);
+        }
+}
+
+template<typename Ntw, bool Implicit>
+auto NtwFusion1U<Ntw,Implicit>::
 fire() noexcept
 {
+    const auto p = draw();
+
+    return host.fuse1L(p[0], p[1], p[2]);
+}
+
+template<typename Ntw, bool Implicit>
+auto NtwFusion1U<Ntw,Implicit>::
+draw() noexcept -> std::array<Ind,3>
+{
+    if constexpr (Implicit) {
+        const auto we1 = ends[rnd.uniform0(ends.size())];
+
+        return {we1[0], we1[1], mt22[rnd.uniform0(mt22.size())]};
+    }
+
     const auto r = rnd.uniform0(cnd.size());
 
-    return host.fuse1L(cnd.u[r][0], cnd.u[r][1],
-                       cnd.v[r]);
+    return {cnd[r].u[0], cnd[r].u[1], cnd[r].v};
 }
 
 
@@ -35,10 +35,15 @@
 
 #include <algorithm>
 #include <array>
+#include <numeric>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "definitions.h"
 #include "edge.h"
+#include "edge_chain.h"
+#include "segment_ends.h"
 
 namespace mitosim {
 
@@ -67,23 +72,40 @@ class Segment {};
  * and its relation to other network components.
  */
 template<>
-class Segment<3> {
+class Segment<3>
+    : public SegmentEnds<3> {
 
 public:
 
-    static constexpr szt numEnds {2};    ///< A segment has two ends.
-    static constexpr szt maxDegree {3};  ///< Maximal node degree allowed.
+    /// The edges are stored individually.
+    static constexpr bool coarse {false};
 
     using EdgeT = Edge<maxDegree>;
     using thisT = Segment<maxDegree>;
+    using FinT = real;  ///< Contribution to fission propensity.
 
-    std::vector<EdgeT> g;  ///< The edges.
+    /// Container of the edges.
+    using Edges = std::conditional_t<chained_edges,
+                                     EdgeChain<EdgeT>,
+                                     std::vector<EdgeT>>;
 
-    /// Number of neighbours (for each of the two ends, counting from 1).
-    std::array<szt,numEnds+1> nn {};
+    /// Container of the edge end factors, stored for heterogeneous fission only.
+    using Fins = std::conditional_t<!heterogeneous_fission,
+                                    NoColumn<FinT>,
+                                    std::conditional_t<chained_edges,
+                                                       EdgeChain<FinT>,
+                                                       std::vector<FinT>>>;
 
-    std::array<std::vector<szt>,numEnds+1> neig;  ///< Neighbour indexes.
-    std::array<std::vector<szt>,numEnds+1> neen;  ///< Neighbour ends.
+    Edges g;  ///< The edges.
+
+    /// Fission-specific factors at the edge ends 0 and 1, parallel to 'g'.
+    std::array<Fins,2> fin;
+
+    /// Storage of the edges and their factors, reusable by another segment.
+    struct Store {
+        Edges g;
+        std::array<Fins,2> fin;
+    };
 
     /**
      * @brief Constructor
@@ -115,13 +137,103 @@ public:
     constexpr auto get_cl() const noexcept { return cl; }
     void set_cl( szt newcl ) noexcept { cl = newcl; }
 
-    /// Reflect the vector containing the segment edges.
-    void reflect_g();
+    /**
+     * @brief Reflect the segment.
+     * @details Only flips the orientation: the edges are reversed
+     * physically by orient() when the storage is spliced.
+     */
+    void reflect_g() noexcept { reversed = !reversed; }
+
+    /// Report if the edges are stored in the reverse order.
+    constexpr auto is_reversed() const noexcept -> bool { return reversed; }
+
+    /// Reverse the edges physically if the segment is reflected.
+    void orient();
+
+    /**
+     * @brief Take over the edges of another segment with their orientation.
+     * @details The other segment is left empty with the storage of this one.
+     * @param o The segment giving away the edges.
+     */
+    void take_g(thisT& o) noexcept;
+
+    /**
+     * @brief Give away the storage of the edges, emptied.
+     * @return The storage, with its capacity retained.
+     */
+    auto release_g() noexcept -> Store;
+
+    /**
+     * @brief Use a released storage for the edges of an empty segment.
+     * @param s The storage.
+     */
+    void adopt_g(Store&& s) noexcept;
+
+    /**
+     * @brief Make room for the edges, unless there is enough already.
+     * @param n Number of the edges needed.
+     */
+    void reserve_g(szt n);
+
+    /**
+     * @brief Move the edges past an in-segment position to another segment.
+     * @details A reflected segment gives away the head of its storage,
+     * so that neither part has to be reversed physically.
+     * @param a In-segment position of the first edge moved.
+     * @param o The segment receiving the edges.
+     */
+    void split_g(szt a, thisT& o);
+
+    /**
+     * @brief Append the storage of another segment to the storage of this one.
+     * @details The orientation flags are not taken into account.
+     * @param o The segment giving away the edges.
+     */
+    void append_g(thisT& o);
+
+    /**
+     * @brief Convert between in-segment and storage positions of an edge.
+     * @param a Position of the edge.
+     */
+    constexpr auto pos(szt a) const noexcept -> szt {
+        return reversed ? g.size() - 1 - a : a;
+    }
+
+    /**
+     * @brief Convert between in-segment and storage edge end indexes.
+     * @param i Edge end index (0 or 1).
+     */
+    constexpr auto side(szt i) const noexcept -> szt {
+        return reversed ? 1 - i : i;
+    }
+
+    /**
+     * @brief Edge at an in-segment position.
+     * @param a In-segment position.
+     */
+    auto edge(szt a) noexcept -> EdgeT& { return g[pos(a)]; }
+    auto edge(szt a) const noexcept -> const EdgeT& { return g[pos(a)]; }
+
+    /**
+     * @brief Fission-specific factor at an edge end.
+     * @details Unless the factors are stored, it is derived from the topology:
+     * only a free segment end does not contribute.
+     * @param a In-segment position of the edge.
+     * @param i Edge end index (0 or 1).
+     */
+    auto get_fin(szt a, szt i) const noexcept -> FinT {
+        if constexpr (heterogeneous_fission)
+            return fin[side(i)][pos(a)];
+        const bool bulk = i ? a + 1 < g.size() || nn[2]
+                            : a || nn[1];
+        return bulk ? one<FinT> : zero<FinT>;
+    }
 
     /**
      * @brief Change cluster index keeping the segment index unoltered.
      * @details Change disconnected network component-related indexes of the
      * segment edges, keeping the segment index unoltered.
+     * The edges are not touched if lazy_edge_cl is set.
      * @param newcl New disconnected component index.
      * @param initind Starting edge index in the current disconnected component.
      */
@@ -140,37 +252,13 @@ public:
     /**
      * @brief Convert segment index to internal position.
      * @details Convert the segment end index of the boundary edge to internal
-     * position in the segment.
+     * position in the segment, i.e. in 'g'.
      * @param e Segment end index.
      * @return Internal position.
      * @return The last edge index in the current disconnected component.
      */
     constexpr auto end2a(szt e) const noexcept -> decltype(g.size());
 
-    /**
-     * @brief Determine if the segment has one free end.
-     * @return The end index if true.
-     */
-    constexpr auto has_one_free_end() const noexcept -> szt;
-
-    /**
-     * @brief Neigbour indexes at a segment end.
-     * @param e Segment end.
-     * @return the Neighbour index.
-     */
-    constexpr auto single_neig_index(szt e) const noexcept -> szt;
-
-    /**
-     * @brief Neigbour indexes at a segment end
-     * @param e Segment end.
-     * @return the Neighbour indexes.
-     */
-    auto double_neig_indexes(szt e) const -> std::vector<szt>;
-
-
-    /// Report if the segment is looped onto itself.
-    constexpr auto is_cycle() const noexcept -> bool;
-
     /**
      * @brief Report the number of nodes of a given degree.
      * @param deg Node degree.
@@ -189,13 +277,19 @@ public:
      * @tparam E In-segment node posiiton.
      */
     template <unsigned E>
-    constexpr auto set_end_fin() noexcept -> real;
+    constexpr auto set_end_fin() noexcept -> FinT;
 
     /**
      * @brief Set fission-specific factor for a bulk node.
      * @param a In-segment node posiiton.
      */
-     auto set_bulk_fin(szt a) -> real;
+     auto set_bulk_fin(szt a) -> FinT;
+
+    /**
+     * @brief Set fission-specific factors for all nodes.
+     * @return Sum of the factors over the edge ends.
+     */
+    auto set_fins() noexcept -> FinT;
 
 
     /// Print segment parameters.
@@ -218,12 +312,24 @@ public:
     /**
      * @brief Write the segment to a binary file.
      * @param ofs std::ofstream to write to.
+     * @param initind Cluster-wide index of the first edge, used if the edges
+     * do not store it.
+     */
+    void write(std::ofstream& ofs, szt initind) const;
+
+    /**
+     * @brief Read the segment from a binary file written by write().
+     * @details The fission-specific factors are consumed with the edges,
+     * and are kept if they are stored.
+     * @param ifs std::ifstream to read from.
      */
-    void write(std::ofstream& ofs) const;
+    void read(std::ifstream& ifs);
 
 protected:
 
     szt cl {};   ///< cluster index.
+
+    bool reversed {};  ///< The edges are stored in the reverse order.
     
     Msgr& msgr;  ///< Output message processor.
 
@@ -235,10 +341,6 @@ protected:
      * @return The pointer to the newly inserted edge.
      */
     auto increment_length(long a, EdgeT p) -> EdgeT*;
-
-
-    /// Initialise the neigbour vectors at both ends.
-    void init_ends();
 };
 
 // IMPLEMENTATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -247,9 +349,7 @@ inline
 Segment<3>::
 Segment(Msgr& msgr)
     : msgr {msgr}
-{
-    init_ends();
-}
+{}
 
 inline
 Segment<3>::
@@ -259,9 +359,7 @@ Segment(
 )
     : cl {cl}
     , msgr {msgr}
-{
-    init_ends();
-}
+{}
 
 inline
 Segment<3>::
@@ -279,18 +377,6 @@ Segment(
 }
 
 
-inline
-void Segment<3>::
-init_ends()
-{
-    neig[1].resize(maxDegree);
-    neig[2].resize(maxDegree);
-
-    neen[1].resize(maxDegree);
-    neen[2].resize(maxDegree);
-}
-
-
 // Inserts a particle imediately after g[a] making it g[a+1].
 inline
 auto Segment<3>::
@@ -299,128 +385,167 @@ increment_length(
     Segment<3>::EdgeT p
 ) -> EdgeT*
 {
-    g.insert(g.begin()+(a+1), std::move(p));
-    return &g[static_cast<szt>(a) + 1];
+    const auto k = static_cast<szt>(a + 1);
+    auto insert = [k](auto& c, auto v) {
+        auto tail = split_off(c, k);
+        c.push_back(std::move(v));
+        append(c, std::move(tail));
+    };
+    insert(g, std::move(p));
+    insert(fin[0], zero<FinT>);
+    insert(fin[1], zero<FinT>);
+    return &g[k];
 }
 
 
 inline
 void Segment<3>::
-reflect_g()
+orient()
 {
-    std::reverse(g.begin(), g.end());
-    for (auto& o : g)
-        o.reflect();
+    if (!reversed) return;
+
+    reverse(g);
+    reverse(fin[0]);
+    reverse(fin[1]);
+    std::swap(fin[0], fin[1]);
+    reversed = false;
 }
 
 
 inline
-auto Segment<3>::
-set_gCl(
-    const szt newcl,
-    const szt initind
-) noexcept -> szt
+void Segment<3>::
+take_g( thisT& o ) noexcept
 {
-    for (szt i=0; i<g.size(); i++) {
-        g[i].cl = newcl;
-        g[i].indcl = initind + i;
-    }
-    
-    return initind + static_cast<szt>(g.size());
+    std::swap(g, o.g);
+    std::swap(fin, o.fin);
+    o.g.clear();
+    o.fin[0].clear();
+    o.fin[1].clear();
+    reversed = o.reversed;
+    o.reversed = false;
 }
 
 
 inline
 auto Segment<3>::
-setCl(
-    const szt newcl,
-    const szt initind
-) noexcept -> szt
+release_g() noexcept -> Store
 {
-    cl = newcl;
-    return set_gCl(newcl, initind);
+    Store s {std::move(g), std::move(fin)};
+    s.g.clear();
+    s.fin[0].clear();
+    s.fin[1].clear();
+    g = {};
+    fin = {};
+    reversed = false;
+    return s;
 }
 
 
-constexpr
-auto Segment<3>::
-end2a( const szt e ) const noexcept -> decltype(g.size())
+inline
+void Segment<3>::
+adopt_g( Store&& s ) noexcept
 {
-    XASSERT(e == 1 || e == 2, "Incorrect end index.");
+    XASSERT(g.empty(), "Error in Segment::adopt_g: the segment has edges.");
 
-    return (e == 1) ? 0 : g.size() - 1;
+    g = std::move(s.g);
+    fin = std::move(s.fin);
 }
 
 
-constexpr
-auto Segment<3>::
-has_one_free_end() const noexcept -> szt  // return the end index if true
+inline
+void Segment<3>::
+reserve_g( const szt n )
 {
-    if (!nn[1] &&  nn[2]) return 1;
-    if ( nn[1] && !nn[2]) return 2;
-    /* else */            return 0;
+    reserve(g, n);
+    reserve(fin[0], n);
+    reserve(fin[1], n);
 }
 
 
-constexpr
+inline
+void Segment<3>::
+split_g(
+    const szt a,
+    thisT& o
+)
+{
+    o.reversed = reversed;
+    if (!reversed) {
+        split_off(g, a, o.g);
+        split_off(fin[0], a, o.fin[0]);
+        split_off(fin[1], a, o.fin[1]);
+        return;
+    }
+    const auto b = g.size() - a;
+    auto give = [b](auto& c, auto& oc) {
+        split_off(c, b, oc);
+        std::swap(c, oc);
+    };
+    give(g, o.g);
+    give(fin[0], o.fin[0]);
+    give(fin[1], o.fin[1]);
+}
+
+
+inline
+void Segment<3>::
+append_g( thisT& o )
+{
+    append(g, std::move(o.g));
+    append(fin[0], std::move(o.fin[0]));
+    append(fin[1], std::move(o.fin[1]));
+}
+
+
+inline
 auto Segment<3>::
-single_neig_index( const szt e ) const noexcept -> szt
+set_gCl(
+    const szt newcl,
+    const szt initind
+) noexcept -> szt
 {
-    for (szt i=1; i<=nn[e]; i++) 
-        if (neig[e][i])
-            return i;
-            
-    return undefined<szt>;
+    // Edge::indcl follows the in-segment order.
+    if constexpr (!lazy_edge_cl) {
+        auto i = reversed ? initind + g.size() - 1 : initind;
+        for (auto& o : g) {
+            o.set_cl(newcl);
+            o.set_indcl(reversed ? i-- : i++);
+        }
+    }
+
+    return initind + static_cast<szt>(g.size());
 }
 
 
 inline
 auto Segment<3>::
-double_neig_indexes( const szt e ) const -> std::vector<szt>
+setCl(
+    const szt newcl,
+    const szt initind
+) noexcept -> szt
 {
-    XASSERT(nn[e] == 2,
-            "Error in Segment::double_neig_indexes: nn[e] != 2 in cluster "+
-            std::to_string(cl)+"\n");
-
-    std::vector<szt> neigInds(nn[e]);
-    for (szt j{}, i{1}; i<=nn[e]; i++)
-        if (neig[e][i])
-            neigInds[j++] = i;
-    
-    return neigInds;
+    cl = newcl;
+    return set_gCl(newcl, initind);
 }
 
 
 constexpr
 auto Segment<3>::
-is_cycle() const noexcept -> bool
+end2a( const szt e ) const noexcept -> decltype(g.size())
 {
-    return nn[1] == 1 && 
-           nn[2] == 1 && 
-           neig[1][single_neig_index(1)] == neig[2][single_neig_index(2)];
+    XASSERT(e == 1 || e == 2, "Incorrect end index.");
+
+    return pos((e == 1) ? 0 : g.size() - 1);
 }
 
 
 constexpr
 auto Segment<3>::
 num_nodes( const szt deg ) const noexcept -> szt // deg = 1, 2, 3
-{                                                        
-    if (deg == 1) {    // count nodes of degree 1
-        if ( nn[1] &&  nn[2]) return 0;
-        if (!nn[1] && !nn[2]) return 2;
-        /* else */            return 1;
-    }
-
-    if (deg == 2)      // count nodes of degree 2
-        return nn[1] && nn[2] && is_cycle()
-               ? g.size()
-               : g.size() - 1;
-
-    if (deg == 3) {     // count nodes of degree 3
-        if (nn[1] == 2 && nn[2] == 2) return 2;
-        if (nn[1] == 2 || nn[2] == 2) return 1;
-        if (nn[1] != 2 && nn[2] != 2) return 0;
-    }
+{
+    const auto n = count_nodes(deg, g.size());
+    if (is_defined(n))
+        return n;
 
     msgr.exit("Error in Segment::num_nodes(). Not implemented for degree ", deg);
     return undefined<szt>;
@@ -429,28 +554,46 @@ num_nodes( const szt deg ) const noexcept -> szt // deg = 1, 2, 3
 
 template <unsigned E> constexpr
 auto Segment<3>::
-set_end_fin() noexcept -> EdgeT::FinT
+set_end_fin() noexcept -> FinT
 {
     static_assert(E == 1 || E == 2, "Incorrect segment end index");
 
-    auto& f = g[end2a(E)].fin;
-    f[E-1] = nn[E] ? one<EdgeT::FinT>
-                   : zero<EdgeT::FinT>;
+    const auto f = nn[E] ? one<FinT>
+                         : zero<FinT>;
+    put(fin[side(E-1)], end2a(E), f);
 
-    return f[E-1];
+    return f;
 }
 
 
 inline
 auto Segment<3>::
-set_bulk_fin( const szt a ) -> EdgeT::FinT
+set_bulk_fin( const szt a ) -> FinT
 {
     XASSERT(a >= 0 || a < g.size() - 1,
             std::string("Incorrect segment edge index: ") + std::to_string(a));
 
-    g[a].fin[1] = g[a+1].fin[0] = one<EdgeT::FinT>;
+    put(fin[side(1)], pos(a), one<FinT>);
+    put(fin[side(0)], pos(a+1), one<FinT>);
 
-    return g[a].fin[1];
+    return one<FinT>;
+}
+
+
+inline
+auto Segment<3>::
+set_fins() noexcept -> FinT
+{
+    // Every edge end facing another edge of the segment is a bulk node.
+    std::fill(fin[0].begin(), fin[0].end(), one<FinT>);
+    std::fill(fin[1].begin(), fin[1].end(), one<FinT>);
+    set_end_fin<1>();
+    set_end_fin<2>();
+
+    if constexpr (!heterogeneous_fission)
+        return static_cast<FinT>(2 * g.size() - !nn[1] - !nn[2]);
+    return std::accumulate(fin[0].begin(), fin[0].end(), zero<FinT>) +
+           std::accumulate(fin[1].begin(), fin[1].end(), zero<FinT>);
 }
 
 
@@ -477,20 +620,16 @@ print( std::ostream& os,
         os << "(of ";
     else
         os << "(at " << at << " of ";
-    os << g.size() << ") [ ";    
-    for (szt i=1; i<=nn[1]; i++) os << neig[1][i] << " ";
-    os << "] { ";        
-    for (szt i=1; i<=nn[1]; i++) os << neen[1][i] << " ";    
-    os << "} [ ";
-    for (szt i=1; i<=nn[2]; i++) os << neig[2][i] << " ";
-    os << "] { ";    
-    for (szt i=1; i<=nn[2]; i++) os << neen[2][i] << " ";    
-    os << "} " << cl;    
+    os << g.size() << ") ";
+    print_ends(os);
+    os << cl;
 
     if constexpr (print_edges) {
         os << std::endl;
-        for (szt i=0; i<g.size(); i++)
-            g[i].print(os, i);
+        for (szt i=0; i<g.size(); i++) {
+            edge(i).print<false>(os, i);
+            os << " fin " << get_fin(i, 0) << " " << get_fin(i, 1) << "\n";
+        }
     }
     else
         os << " len " << g.size();
@@ -501,27 +640,51 @@ print( std::ostream& os,
 
 inline
 void Segment<3>::
-write( std::ofstream& ofs ) const
+write(
+    std::ofstream& ofs,
+    const szt initind
+) const
 {
     const auto len = static_cast<szt>(g.size());
     ofs.write(reinterpret_cast<const char*>(&len), sizeof(szt));
     ofs.write(reinterpret_cast<const char*>(&cl), sizeof(szt));
-    
-    ofs.write(reinterpret_cast<const char*>(&nn[1]), sizeof(szt));
-    
-    for (szt j=1; j<=nn[1]; j++) {
-        ofs.write(reinterpret_cast<const char*>(&neig[1][j]), sizeof(szt));
-        ofs.write(reinterpret_cast<const char*>(&neen[1][j]), sizeof(szt));
+    write_ends(ofs);
+
+    for (szt i=0; i<g.size(); i++) {
+        const auto& e = edge(i);
+        if constexpr (lazy_edge_cl)
+            e.write(ofs, initind + i, cl);
+        else
+            e.write(ofs, e.get_indcl(), e.get_cl());
+        for (szt j=0; j<2; j++) {
+            const auto f = get_fin(i, j);
+            ofs.write(reinterpret_cast<const char*>(&f), sizeof(FinT));
+        }
     }
-    
-    ofs.write(reinterpret_cast<const char*>(&nn[2]), sizeof(int));
-    
-    for (szt j=1; j<=nn[2]; j++) {
-        ofs.write(reinterpret_cast<const char*>(&neig[2][j]), sizeof(szt));
-        ofs.write(reinterpret_cast<const char*>(&neen[2][j]), sizeof(szt));
+}
+
+
+inline
+void Segment<3>::
+read( std::ifstream& ifs )
+{
+    szt len {};
+    ifs.read(reinterpret_cast<char*>(&len), sizeof(szt));
+    ifs.read(reinterpret_cast<char*>(&cl), sizeof(szt));
+    read_ends(ifs);
+
+    g.clear();
+    fin[0].clear();
+    fin[1].clear();
+    reversed = false;
+    for (szt i=0; i<len; i++) {
+        g.push_back(EdgeT{ifs});
+        for (szt j=0; j<2; j++) {
+            FinT f {};
+            ifs.read(reinterpret_cast<char*>(&f), sizeof(FinT));
+            fin[j].push_back(f);
+        }
     }
-    for (const auto& a : g)
-        a.write(ofs);
 }
 
 }  // namespace mitosim
@@ -0,0 +1,252 @@
+/* =============================================================================
+   Copyright (C) 2015 Valerii Sukhorukov & Michael Meyer-Hermann,
+   Helmholtz Center for Infection Research (Braunschweig, Germany).
+   All Rights Reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all
+   copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+================================================================================
+*/
+
+/**
+ * @file segment_ends.h
+ * @brief Contains the end topology shared by the Segment representations.
+ * @author Valerii Sukhorukov
+ */
+
+#ifndef MITOSIM_SEGMENT_ENDS_H
+#define MITOSIM_SEGMENT_ENDS_H
+
+#include <array>
+#include <fstream>
+#include <ostream>
+
+#include "definitions.h"
+
+namespace mitosim {
+
+/**
+ * @brief Class template for the segment end topology.
+ * @details Holds the connections of the two segment ends to other segments,
+ * independently of how the segment body is represented.
+ * @tparam _ Max node degree that the graph is able to handle.
+ */
+template<unsigned _>
+class SegmentEnds {};
+
+/**
+ * @brief Segment end topology for max node degree equal to 3.
+ */
+template<>
+class SegmentEnds<3> {
+
+public:
+
+    static constexpr szt numEnds {2};    ///< A segment has two ends.
+    static constexpr szt maxDegree {3};  ///< Maximal node degree allowed.
+
+    /// Neighbour slots at a segment end, counting from 1.
+    using Neigs = std::array<szt,maxDegree>;
+
+    /// Number of neighbours (for each of the two ends, counting from 1).
+    std::array<szt,numEnds+1> nn {};
+
+    // Stored inline, so that the end topology takes no heap blocks.
+    std::array<Neigs,numEnds+1> neig {};  ///< Neighbour indexes.
+    std::array<Neigs,numEnds+1> neen {};  ///< Neighbour ends.
+
+    /**
+     * @brief Determine if the segment has one free end.
+     * @return The end index if true.
+     */
+    constexpr auto has_one_free_end() const noexcept -> szt;
+
+    /**
+     * @brief Neigbour indexes at a segment end.
+     * @param e Segment end.
+     * @return the Neighbour index.
+     */
+    constexpr auto single_neig_index(szt e) const noexcept -> szt;
+
+    /**
+     * @brief Neigbour indexes at a segment end
+     * @param e Segment end.
+     * @return the Neighbour indexes.
+     */
+    auto double_neig_indexes(szt e) const -> std::array<szt,2>;
+
+    /// Report if the segment is looped onto itself.
+    constexpr auto is_cycle() const noexcept -> bool;
+
+protected:
+
+    /**
+     * @brief Report the number of nodes of a given degree.
+     * @param deg Node degree.
+     * @param len Segment length measured in edges.
+     * @return the Number of nodes, undefined for an unsupported degree.
+     */
+    constexpr auto count_nodes(szt deg, szt len) const noexcept -> szt;
+
+    /// Print the neighbours at the segment ends.
+    void print_ends(std::ostream& os) const;
+
+    /// Write the neighbours at the segment ends to a binary file.
+    void write_ends(std::ofstream& ofs) const;
+
+    /// Read the neighbours at the segment ends from a binary file.
+    void read_ends(std::ifstream& ifs);
+};
+
+// IMPLEMENTATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+constexpr
+auto SegmentEnds<3>::
+has_one_free_end() const noexcept -> szt  // return the end index if true
+{
+    if (!nn[1] &&  nn[2]) return 1;
+    if ( nn[1] && !nn[2]) return 2;
+    /* else */            return 0;
+}
+
+
+constexpr
+auto SegmentEnds<3>::
+single_neig_index( const szt e ) const noexcept -> szt
+{
+    for (szt i=1; i<=nn[e]; i++)
+        if (neig[e][i])
+            return i;
+
+    return undefined<szt>;
+}
+
+
+inline
+auto SegmentEnds<3>::
+double_neig_indexes( const szt e ) const -> std::array<szt,2>
+{
+    XASSERT(nn[e] == 2,
+            "Error in Segment::double_neig_indexes: nn[e] != 2\n");
+
+    std::array<szt,2> neigInds {};
+    for (szt j{}, i{1}; i<=nn[e]; i++)
+        if (neig[e][i])
+            neigInds[j++] = i;
+
+    return neigInds;
+}
+
+
+constexpr
+auto SegmentEnds<3>::
+is_cycle() const noexcept -> bool
+{
+    return nn[1] == 1 &&
+           nn[2] == 1 &&
+           neig[1][single_neig_index(1)] == neig[2][single_neig_index(2)];
+}
+
+
+constexpr
+auto SegmentEnds<3>::
+count_nodes( const szt deg,
+             const szt len ) const noexcept -> szt  // deg = 1, 2, 3
+{
+    if (deg == 1) {    // count nodes of degree 1
+        if ( nn[1] &&  nn[2]) return 0;
+        if (!nn[1] && !nn[2]) return 2;
+        /* else */            return 1;
+    }
+
+    if (deg == 2)      // count nodes of degree 2
+        return nn[1] && nn[2] && is_cycle()
+               ? len
+               : len - 1;
+
+    if (deg == 3) {     // count nodes of degree 3
+        if (nn[1] == 2 && nn[2] == 2) return 2;
+        if (nn[1] == 2 || nn[2] == 2) return 1;
+        if (nn[1] != 2 && nn[2] != 2) return 0;
+    }
+
+    return undefined<szt>;
+}
+
+
+inline
+void SegmentEnds<3>::
+print_ends( std::ostream& os ) const
+{
+    os << "[ ";
+    for (szt i=1; i<=nn[1]; i++) os << neig[1][i] << " ";
+    os << "] { ";
+    for (szt i=1; i<=nn[1]; i++) os << neen[1][i] << " ";
+    os << "} [ ";
+    for (szt i=1; i<=nn[2]; i++) os << neig[2][i] << " ";
+    os << "] { ";
+    for (szt i=1; i<=nn[2]; i++) os << neen[2][i] << " ";
+    os << "} ";
+}
+
+
+inline
+void SegmentEnds<3>::
+write_ends( std::ofstream& ofs ) const
+{
+    ofs.write(reinterpret_cast<const char*>(&nn[1]), sizeof(szt));
+
+    for (szt j=1; j<=nn[1]; j++) {
+        ofs.write(reinterpret_cast<const char*>(&neig[1][j]), sizeof(szt));
+        ofs.write(reinterpret_cast<const char*>(&neen[1][j]), sizeof(szt));
+    }
+
+    ofs.write(reinterpret_cast<const char*>(&nn[2]), sizeof(int));
+
+    for (szt j=1; j<=nn[2]; j++) {
+        ofs.write(reinterpret_cast<const char*>(&neig[2][j]), sizeof(szt));
+        ofs.write(reinterpret_cast<const char*>(&neen[2][j]), sizeof(szt));
+    }
+}
+
+
+inline
+void SegmentEnds<3>::
+read_ends( std::ifstream& ifs )
+{
+    ifs.read(reinterpret_cast<char*>(&nn[1]), sizeof(szt));
+
+    for (szt j=1; j<=nn[1]; j++) {
+        ifs.read(reinterpret_cast<char*>(&neig[1][j]), sizeof(szt));
+        ifs.read(reinterpret_cast<char*>(&neen[1][j]), sizeof(szt));
+    }
+
+    // The count at end 2 is written with the width of int.
+    int n2 {};
+    ifs.read(reinterpret_cast<char*>(&n2), sizeof(int));
+    nn[2] = static_cast<szt>(n2);
+
+    for (szt j=1; j<=nn[2]; j++) {
+        ifs.read(reinterpret_cast<char*>(&neig[2][j]), sizeof(szt));
+        ifs.read(reinterpret_cast<char*>(&neen[2][j]), sizeof(szt));
+    }
+}
+
+}  // namespace mitosim
+
+#endif  // MITOSIM_SEGMENT_ENDS_H
@@ -32,9 +32,17 @@
 #ifndef MITOSIM_SIMULATION_H
 #define MITOSIM_SIMULATION_H
 
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
 #include "utils/stochastic/gillespie.h"
 
 #include "definitions.h"
+#include "next_reaction.h"
+#include "tau_leaping.h"
 #include "reactions/fission.h"
 #include "reactions/fusion11.h"
 #include "reactions/fusion12.h"
@@ -42,13 +50,29 @@
 
 namespace mitosim {
 
+/// Stochastic engine drawing the reaction events, as set by tau_leaping
+/// and next_reaction_method. Any type of the same interface can be used instead.
+using ReactionEngine = std::conditional_t<
+    tau_leaping,
+    TauLeaping<RandFactory, utils::stochastic::Reaction<RandFactory>>,
+    std::conditional_t<
+        next_reaction_method,
+        NextReaction<RandFactory, utils::stochastic::Reaction<RandFactory>>,
+        utils::stochastic::Gillespie<RandFactory,
+                                     utils::stochastic::Reaction<RandFactory>>>>;
+
 /**
  * @brief The Simulation class.
  * @details Handles the overall simulation process and its termination.
- * The reactions are encapsulated inside the Gillespie object, constructed here.
+ * The reactions are encapsulated inside the engine object, constructed here.
  * Controlls the output.
+ * @tparam Ntw Type of the network.
+ * @tparam EngineT Stochastic engine: utils::stochastic::Gillespie,
+ * NextReaction, TauLeaping or a type of the same interface. The engines
+ * taking the reactant numbers along with the reactions get them.
  */
-template<typename Ntw>
+template<typename Ntw,
+         typename EngineT=ReactionEngine>
 class Simulation {
 
 public:
@@ -70,7 +94,7 @@ public:
     );
 
     /// Make everything ready for start.
-    auto initialize() -> Simulation<Ntw>&;
+    auto initialize() -> Simulation&;
 
     void operator()();  ///< Runs the simulation.
 
@@ -88,11 +112,18 @@ private:
     szt logFrequency;   ///< Frequency of short output to a log line.
     szt saveFrequency;  ///< Frequency of detailed output to flie.
 
-    /// Gillespie reactor controlling the simulation.
-    utils::stochastic::Gillespie<RandFactory,
-                                 utils::stochastic::Reaction<RandFactory>> gsp;
+    EngineT gsp;  ///< Stochastic engine controlling the simulation.
+
+    void populateRc();  ///< Add reactions to the stochastic engine.
 
-    void populateRc();  ///< Add reactions to the Gillespie simulator.
+    /**
+     * @brief Add a reaction to the stochastic engine.
+     * @param r The reaction.
+     * @param pool Number of reactants available to the reaction.
+     */
+    template<typename R>
+    void add_reaction(std::unique_ptr<R> r,
+                      std::function<szt()> pool);
 
     /**
      * @brief Terminate the simulation early due to the reactant exhaustion.
@@ -108,8 +139,8 @@ private:
 
 // IMPLEMENTATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-template<typename Ntw>
-Simulation<Ntw>::
+template<typename Ntw, typename EngineT>
+Simulation<Ntw, EngineT>::
 Simulation(
         Ntw& netw,
         RandFactory& rnd,
@@ -127,9 +158,9 @@ Simulation(
     , gsp {rnd}
 {}
 
-template<typename Ntw>
-auto Simulation<Ntw>::
-initialize() -> Simulation<Ntw>&
+template<typename Ntw, typename EngineT>
+auto Simulation<Ntw, EngineT>::
+initialize() -> Simulation&
 {
     populateRc();
     gsp.initialize();
@@ -138,31 +169,58 @@ initialize() -> Simulation<Ntw>&
 }
 
 
-template<typename Ntw>
-void Simulation<Ntw>::
+template<typename Ntw, typename EngineT>
+void Simulation<Ntw, EngineT>::
 populateRc()
 {
+    // Reactants: the fission sites counted by their weights, the free ends
+    // for fusion, and also the separate cycles for fusion to a cycle.
+    const auto sites = [this] {
+        return static_cast<szt>(netw.fis.get_prTotal());
+    };
+    const auto ends = [this] {
+        return 2 * netw.mt11.size() + netw.mt13.size();
+    };
+    const auto cycles = [this, ends] {
+        return std::min(ends(), netw.mt22.size());
+    };
+
     szt ind {};
     if (netw.cfg.use_fission)
-        gsp.add_reaction(std::make_unique<Fission <Ntw>>(
-            msgr, ind++, netw, netw.cfg.rate_fission));
+        add_reaction(std::make_unique<Fission <Ntw>>(
+            msgr, ind++, netw, netw.cfg.rate_fission), sites);
 
     if (netw.cfg.use_11_fusion)
-        gsp.add_reaction(std::make_unique<Fusion11<Ntw>>(
-            msgr, ind++, netw, netw.cfg.fusion_rate_11));
+        add_reaction(std::make_unique<Fusion11<Ntw>>(
+            msgr, ind++, netw, netw.cfg.fusion_rate_11), ends);
 
     if (netw.cfg.use_12_fusion)
-        gsp.add_reaction(std::make_unique<Fusion12<Ntw>>(
-            msgr, ind++, netw, netw.cfg.fusion_rate_12));
+        add_reaction(std::make_unique<Fusion12<Ntw>>(
+            msgr, ind++, netw, netw.cfg.fusion_rate_12), ends);
 
     if (netw.cfg.use_1L_fusion)
-        gsp.add_reaction(std::make_unique<Fusion1U<Ntw>>(
-            msgr, ind++, netw, netw.cfg.fusion_rate_1L));
+        add_reaction(std::make_unique<Fusion1U<Ntw>>(
+            msgr, ind++, netw, netw.cfg.fusion_rate_1L), cycles);
+}
+
+
+template<typename Ntw, typename EngineT>
+template<typename R>
+void Simulation<Ntw, EngineT>::
+add_reaction(
+    std::unique_ptr<R> r,
+    std::function<szt()> pool
+)
+{
+    if constexpr (requires { gsp.add_reaction(std::move(r), pool); })
+        gsp.add_reaction(std::move(r), std::move(pool));
+    else
+        gsp.add_reaction(std::move(r));
 }
 
 
-template<typename Ntw>
-void Simulation<Ntw>::
+template<typename Ntw, typename EngineT>
+void Simulation<Ntw, EngineT>::
 operator()()
 {
     netw.update_node_numbers();
@@ -203,8 +261,8 @@ operator()()
 }
 
 
-template<typename Ntw>
-void Simulation<Ntw>::
+template<typename Ntw, typename EngineT>
+void Simulation<Ntw, EngineT>::
 terminate( const std::string& s )
 {
     netw.update_node_numbers();
@@ -213,8 +271,8 @@ terminate( const std::string& s )
 }
 
 
-template<typename Ntw>
-void Simulation<Ntw>::
+template<typename Ntw, typename EngineT>
+void Simulation<Ntw, EngineT>::
 update_log()
 {
     update_log(*msgr.so);
@@ -222,8 +280,8 @@ update_log()
 }
 
 
-template<typename Ntw>
-void Simulation<Ntw>::
+template<typename Ntw, typename EngineT>
+void Simulation<Ntw, EngineT>::
 update_log( std::ostream &ofs )
 {
     ofs << it << " t " << time;
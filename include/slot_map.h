@@ -0,0 +1,186 @@
+/* =============================================================================
+   Copyright (C) 2015 Valerii Sukhorukov & Michael Meyer-Hermann,
+   Helmholtz Center for Infection Research (Braunschweig, Germany).
+   All Rights Reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all
+   copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+================================================================================
+*/
+
+/**
+ * @file slot_map.h
+ * @brief Contains a slot map issuing stable handles to dense array elements.
+ * @author Valerii Sukhorukov
+ */
+
+#ifndef MITOSIM_SLOT_MAP_H
+#define MITOSIM_SLOT_MAP_H
+
+#include <vector>
+
+#include "definitions.h"
+
+namespace mitosim {
+
+/**
+ * @brief Generational handle of an element stored in a dense array.
+ * @tparam Ind Index type.
+ */
+template<typename Ind>
+struct SlotHandle {
+
+    Ind slot {undefined<Ind>};  ///< Slot index.
+    Ind gen {};                 ///< Generation of the slot at the issue.
+
+    constexpr bool operator==(const SlotHandle&) const noexcept = default;
+};
+
+/**
+ * @brief Slot map following the elements of a swap-remove dense array.
+ * @details The elements themselves stay in the dense array, which on
+ * removal of an element moves the last one into its place. The map follows
+ * such moves, so that a handle resolves to the element it was issued for
+ * until the element is erased. Erasing advances the slot generation, which
+ * invalidates the outstanding handles, and returns the slot to a free list.
+ * @tparam Ind Index type.
+ */
+template<typename Ind>
+class SlotMap {
+
+public:
+
+    using Handle = SlotHandle<Ind>;
+
+    /**
+     * @brief Issue a handle for a new element.
+     * @param d Dense index of the element.
+     */
+    Handle insert(szt d);
+
+    /**
+     * @brief Invalidate the handle of an element.
+     * @param d Dense index of the element.
+     */
+    void erase(szt d) noexcept;
+
+    /**
+     * @brief Follow an element moved to another position.
+     * @param f Former dense index of the element.
+     * @param t New dense index, vacated by erase().
+     */
+    void move(szt f, szt t) noexcept;
+
+    /**
+     * @brief Handle of an element.
+     * @param d Dense index of the element.
+     */
+    Handle handle(const szt d) const noexcept
+    {
+        return {slotOf[d], slots[slotOf[d]].gen};
+    }
+
+    /**
+     * @brief Dense index of the element referred to by a handle.
+     * @param h The handle.
+     * @return The index, or undefined<szt> if the element has been erased.
+     */
+    szt index(Handle h) const noexcept;
+
+    /// Tells if the element referred to by a handle still exists.
+    bool contains(const Handle h) const noexcept
+    {
+        return is_defined(index(h));
+    }
+
+    /// Number of the elements.
+    szt size() const noexcept { return slots.size() - freeSlots.size(); }
+
+private:
+
+    /// Dense index of the element occupying a slot and its generation.
+    struct Slot {
+        Ind dense {undefined<Ind>};
+        Ind gen {};
+    };
+
+    std::vector<Slot> slots;      ///< The slots.
+    std::vector<Ind>  slotOf;     ///< Slot of each dense index.
+    std::vector<Ind>  freeSlots;  ///< Slots available for reuse.
+};
+
+// IMPLEMENTATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+template<typename Ind>
+auto SlotMap<Ind>::
+insert( const szt d ) -> Handle
+{
+    Ind s;
+    if (freeSlots.empty()) {
+        s = static_cast<Ind>(slots.size());
+        slots.emplace_back();
+        // Keeps erase() from reallocating.
+        freeSlots.reserve(slots.capacity());
+    }
+    else {
+        s = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    if (d >= slotOf.size())
+        slotOf.resize(d + 1, undefined<Ind>);
+
+    slots[s].dense = static_cast<Ind>(d);
+    slotOf[d] = s;
+
+    return {s, slots[s].gen};
+}
+
+template<typename Ind>
+void SlotMap<Ind>::
+erase( const szt d ) noexcept
+{
+    const auto s = slotOf[d];
+    slots[s].dense = undefined<Ind>;
+    slots[s].gen++;
+    slotOf[d] = undefined<Ind>;
+    freeSlots.push_back(s);
+}
+
+template<typename Ind>
+void SlotMap<Ind>::
+move( const szt f, const szt t ) noexcept
+{
+    const auto s = slotOf[f];
+    slots[s].dense = static_cast<Ind>(t);
+    slotOf[t] = s;
+    slotOf[f] = undefined<Ind>;
+}
+
+template<typename Ind>
+szt SlotMap<Ind>::
+index( const Handle h ) const noexcept
+{
+    if (h.slot >= slots.size() || slots[h.slot].gen != h.gen)
+        return undefined<szt>;
+
+    return slots[h.slot].dense;
+}
+
+}  // namespace mitosim
+
+#endif  // MITOSIM_SLOT_MAP_H
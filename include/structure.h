@@ -32,10 +32,16 @@
 #ifndef MITOSIM_STRUCTURE_H
 #define MITOSIM_STRUCTURE_H
 
+#include <algorithm>
 #include <array>
+#include <limits>
+#include <tuple>
 #include <vector>
 
 #include "definitions.h"
+#include "junctions.h"
+#include "paged_vector.h"
+#include "slot_map.h"
 
 namespace mitosim {
 
@@ -44,19 +50,30 @@ namespace mitosim {
  * @details Encapsulates the major structure-related proterties, such a
  * collection of the Segments, but is unaware of any dynamics.
  * Forms base for clases adding the network reconfiguration dynamics.
+ * The storage is retained as the segments and clusters come and go, so that
+ * a settled network allocates only when a segment, a cluster or a class
+ * outgrows the largest size its buffer has held.
  * @tparam Mt Type of the Edge forming the network.
+ * @tparam Ind Index type of the network-wide tables.
 */
-template<typename Mt>
+template<typename Mt, typename Ind=Index>
 class Structure {
 
 public:
 
-    using Reticulum = std::vector<Mt>;
+    /// Container of the segments: these never move as it grows.
+    using Reticulum = PagedVector<Mt>;
+    using IndT = Ind;  ///< Index type of the network-wide tables.
+    using Handle = SlotHandle<Ind>;  ///< Stable segment handle.
+    /// Segment index and end index.
+    using SegEnd = std::array<Ind,2>;
 
     /// Mapping of the edge indexes to segment indexes.
-    std::vector<szt> glm;
-    /// Mapping of the edge indexes to element index inside segments.
-    std::vector<szt> gla;
+    /// Both mappings stay empty for segments without edges (Mt::coarse).
+    std::vector<Ind> glm;
+    /// Mapping of the edge indexes to element index inside segment storage.
+    /// Use Segment::pos() to obtain the in-segment position.
+    std::vector<Ind> gla;
 
     /// The segments.
     Reticulum mt;
@@ -72,31 +89,54 @@ public:
     szt mtmass {};
 
     /// Segment indices segregated into clusters: clmt - total.
-    vec2<szt> clmt;
+    /// @note Kept current through transformations, but ordered by segment
+    /// index only after populate_cluster_vectors().
+    vec2<Ind> clmt;
+    /// Position of each segment in its 'clmt' list.
+    std::vector<Ind> clpos;
     /// Cluster sizes measured in edges.
-    std::vector<szt> cls;
+    std::vector<Ind> cls;
 
     // Segment indices of the corresponding end degrees.
 
     /// Indexes of disconnected segments not looped onto itself.
-    std::vector<szt> mt11;
+    std::vector<Ind> mt11;
     /// Indexes of disconnected segments not looped onto itself.
-    std::vector<szt> mtc11;
+    std::vector<Ind> mtc11;
 
     /// Indexes of disconnected looped segments.
-    std::vector<szt> mt22;
+    std::vector<Ind> mt22;
     /// Indexes of disconnected looped segments.
-    std::vector<szt> mtc22;
+    std::vector<Ind> mtc22;
 
     /// Indexes of segments between nodes of degree 3 and 3: all together.
-    std::vector<szt> mt33;
+    std::vector<Ind> mt33;
     /// Indexes of segments between nodes of degree 3 and 3: sorted into clusters.
-    vec2<szt> mtc33;
+    /// @note Not shrunk as clusters vanish: entries past 'clnum' are empty.
+    vec2<Ind> mtc33;
 
     /// {index,end} Pairs for segments between nodes of degs. 1 and 3 together.
-    std::vector<std::array<szt,2>> mt13;
+    std::vector<SegEnd> mt13;
     /// {index,end} Pairs for segments between nodes of degs. 1 and 3: sorted into clusters.
-    vec2<std::array<szt,2>> mtc13;
+    /// @note Not shrunk as clusters vanish: entries past 'clnum' are empty.
+    vec2<SegEnd> mtc13;
+
+    /// Nodes joining the segment ends.
+    /// @note Written by the transformations along with the neighbour lists.
+    Junctions<Ind> junctions;
+
+    /// Stable handles of the segments: unlike the indexes, these survive
+    /// the renumbering of segments as they emerge and vanish.
+    SlotMap<Ind> handles;
+
+    /// Segments touched by transformations since the last propensity update.
+    std::vector<szt> touched;
+
+    /// Segments to be reclassified by the next incremental structure update.
+    std::vector<szt> pending;
+
+    /// Skip the incremental structure updates, letting 'pending' accumulate.
+    bool deferred {};
 
     /// Output message processor.
     Msgr& msgr;
@@ -113,15 +153,103 @@ public:
     /// Appends a disconnected segment to the reticulum.
     void add_disconnected_segment(szt segmass);
 
-    /// Updates internal vectors.
+    /**
+     * @brief Updates internal vectors.
+     * @details The incremental update is skipped while 'deferred' is set.
+     */
     void update_structure() noexcept;
 
+    /**
+     * @brief Record a segment as touched by a transformation.
+     * @param w Segment index.
+     */
+    void touch(szt w) { touched.push_back(w); pending.push_back(w); }
+
+    /**
+     * @brief Record a segment as moved to another cluster.
+     * @details Unlike touch(), this does not affect the fusion candidates.
+     * @param w Segment index.
+     */
+    void recluster(szt w) { pending.push_back(w); }
+
+    /**
+     * @brief Append a segment to the member list of its cluster.
+     * @param w Segment index.
+     */
+    void add_to_cluster(szt w);
+
+    /**
+     * @brief Remove a segment from the member list of its cluster.
+     * @details The last member takes the place of the removed one.
+     * @param w Segment index.
+     */
+    void remove_from_cluster(szt w) noexcept;
+
+    /**
+     * @brief Substitute a segment index in the member list of its cluster.
+     * @param f Current segment index.
+     * @param t New segment index.
+     */
+    void rename_in_cluster(szt f, szt t);
+
+    /// Append an empty segment, reusing the storage of a removed one.
+    void push_segment();
+
+    /// Remove the last segment, keeping its storage for reuse.
+    void pop_segment();
+
+    /**
+     * @brief Make room for the edges of a segment.
+     * @param w Segment index.
+     * @param n Number of the edges needed.
+     */
+    void reserve_g(szt w, szt n);
+
     /// Initializes or updates glm and gla vectors.
     void make_indma() noexcept;
 
+    /**
+     * @brief Points 'glm' and 'gla' at the elements of a segment.
+     * @param w Segment index.
+     * @param from Position of the first element to map.
+     */
+    void map_edges(szt w, szt from=0) noexcept;
+
+    /**
+     * @brief Cluster index of an edge.
+     * @param w Segment index.
+     * @param a In-segment position of the edge.
+     */
+    auto edge_cl(szt w, szt a) const noexcept -> szt;
+
+    /**
+     * @brief Cluster-wide index of an edge.
+     * @details Unless stored in the edge, it is derived from the lengths
+     * of the cluster members preceding the segment by index.
+     * @param w Segment index.
+     * @param a In-segment position of the edge.
+     */
+    auto edge_indcl(szt w, szt a) const noexcept -> szt;
+
+    /**
+     * @brief Cluster-wide index of the first edge of every segment.
+     * @details Members of a cluster are numbered in the order of their
+     * segment indexes.
+     */
+    auto indcl_offsets() const -> std::vector<szt>;
+
     /// Populates 'mt??', 'mtc??', 'nn' and 'clmt' vectors
     void populate_cluster_vectors() noexcept;
 
+    /**
+     * @brief Updates 'mt??', 'mtc??', 'cls' and 'nn' for the pending segments.
+     * @details Only the segments recorded by touch() and recluster() since
+     * the last update are reclassified; their former entries are
+     * swap-removed from the class vectors. Unlike populate_cluster_vectors(),
+     * this does not reorder 'clmt'.
+     */
+    void update_cluster_vectors() noexcept;
+
     /**
      * Updates 'nn' for the specific node degree.
      * @tparam I Node degree to consider.
@@ -144,12 +272,51 @@ public:
      */
     void print(std::ostream& ofs) const;
 
+private:
+
+    /// Classification of a segment as filed in the class vectors.
+    struct Filing {
+        int kind {};    ///< 0: unfiled, 1: mt11, 2: mt22, 3: mt33, 4: mt13.
+        szt cl {};      ///< Cluster the segment is filed under.
+        szt len {};     ///< Contribution to 'cls'.
+        szt pos {};     ///< Position in the 'mt??' vector.
+        szt cpos {};    ///< Position in the 'mtc33' or 'mtc13' vector.
+        szt n0 {};      ///< Contribution to nn[0].
+        szt n1 {};      ///< Contribution to nn[1].
+    };
+
+    /// Filing records indexed by segment.
+    std::vector<Filing> filed;
+
+    /// Reclassification flags for deduplication of 'pending'.
+    std::vector<bool> isPending;
+
+    /// Edge storage of the removed segments, kept for the emerging ones.
+    std::vector<typename Mt::Store> spare;
+
+    /**
+     * @brief Classify a segment and append it to the class vectors.
+     * @param j Segment index.
+     */
+    void file(szt j) noexcept;
+
+    /**
+     * @brief Remove a segment from the class vectors it is filed in.
+     * @param j Segment index.
+     */
+    void unfile(szt j) noexcept;
+
+    /// Checks the incrementally updated vectors against a full rebuild.
+    void verify_cluster_vectors() noexcept;
+
+    /// Checks the node table against the neighbour lists.
+    void verify_junctions() noexcept;
 };
 
 // IMPLEMENTATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
-template<typename Mt>
-Structure<Mt>::
+template<typename Mt, typename Ind>
+Structure<Mt, Ind>::
 Structure(
         Msgr& msgr
     )
@@ -157,113 +324,435 @@ Structure(
 {}
 
 
-template<typename Mt>
-void Structure<Mt>::
+template<typename Mt, typename Ind>
+void Structure<Mt, Ind>::
 add_disconnected_segment( const szt segmass )
 {
+    if (mtmass + segmass > std::numeric_limits<Ind>::max())
+        msgr.exit("The network exceeds the range of its index type");
+
     if (mt.empty())
         mt.emplace_back(msgr);  // Mock segment necessary for 1-based counting.
 
     mt.emplace_back(segmass, clnum, mtmass, msgr);
     mtnum++;
+    handles.insert(mtnum);
+    touch(mtnum);
     clnum++;
     mtmass += segmass;
+    add_to_cluster(mtnum);
+    if constexpr (!Mt::coarse) {
+        glm.resize(mtmass);
+        gla.resize(mtmass);
+        map_edges(mtnum);
+    }
+}
+
+
+template<typename Mt, typename Ind>
+void Structure<Mt, Ind>::
+add_to_cluster( const szt w )
+{
+    const auto c = mt[w].get_cl();
+    if (c >= clmt.size())
+        clmt.resize(c + 1);
+    if (w >= clpos.size())
+        clpos.resize(w + 1);
+
+    clpos[w] = clmt[c].size();
+    clmt[c].push_back(w);
+}
+
+
+template<typename Mt, typename Ind>
+void Structure<Mt, Ind>::
+remove_from_cluster( const szt w ) noexcept
+{
+    auto& l = clmt[mt[w].get_cl()];
+    const auto last = l.back();
+    l[clpos[w]] = last;
+    clpos[last] = clpos[w];
+    l.pop_back();
+}
+
+
+template<typename Mt, typename Ind>
+void Structure<Mt, Ind>::
+rename_in_cluster( const szt f, const szt t )
+{
+    if (t >= clpos.size())
+        clpos.resize(t + 1);
+
+    clmt[mt[f].get_cl()][clpos[f]] = t;
+    clpos[t] = clpos[f];
+}
+
+
+template<typename Mt, typename Ind>
+void Structure<Mt, Ind>::
+push_segment()
+{
+    mt.emplace_back(msgr);
+    if (spare.empty()) return;
+
+    mt.back().adopt_g(std::move(spare.back()));
+    spare.pop_back();
+}
+
+
+template<typename Mt, typename Ind>
+void Structure<Mt, Ind>::
+pop_segment()
+{
+    XASSERT(!is_defined(junctions.at(mt.size()-1, 1)) &&
+            !is_defined(junctions.at(mt.size()-1, 2)),
+            "Error in pop_segment: the segment ends are still linked.\n");
+
+    spare.push_back(mt.back().release_g());
+    mt.pop_back();
+}
+
+
+template<typename Mt, typename Ind>
+void Structure<Mt, Ind>::
+reserve_g( const szt w, const szt n )
+{
+    mt[w].reserve_g(n);
 }
 
 
-template<typename Mt> inline
-void Structure<Mt>::
+template<typename Mt, typename Ind> inline
+void Structure<Mt, Ind>::
 update_structure() noexcept
 {
-    make_indma();
-    populate_cluster_vectors();
+    if constexpr (incremental_structure) {
+        if (deferred) return;
+        update_cluster_vectors();
+        if constexpr (verify_structure) {
+            verify_cluster_vectors();
+            verify_junctions();
+        }
+    }
+    else {
+        make_indma();
+        populate_cluster_vectors();
+    }
 }
 
-template<typename Mt> inline
-void Structure<Mt>::
+template<typename Mt, typename Ind> inline
+void Structure<Mt, Ind>::
 make_indma() noexcept
 {
     cls.resize(clnum);
     std::fill(cls.begin(), cls.end(), 0);    // cluster size, # of edges
     for (szt j=1; j<=mtnum; j++)
-        cls[mt[j].get_cl()] += mt[j].g.size();
+        cls[mt[j].get_cl()] += mt[j].length();
 
-    glm.resize(mtmass);
-    gla.resize(mtmass);
-    for (szt j=1; j<=mtnum; j++)
-        for (szt k=0; k<mt[j].g.size(); k++) {
-            const auto& g = mt[j].g[k];
-            glm[g.get_ind()] = j;
-            gla[g.get_ind()] = k;
+    if constexpr (!Mt::coarse) {
+        glm.resize(mtmass);
+        gla.resize(mtmass);
+        for (szt j=1; j<=mtnum; j++)
+            map_edges(j);
+    }
+}
+
+template<typename Mt, typename Ind> inline
+void Structure<Mt, Ind>::
+map_edges( const szt w, const szt from ) noexcept
+{
+    if constexpr (!Mt::coarse) {
+        const auto& g = mt[w].g;
+        auto k = from;
+        for (auto o=g.begin()+static_cast<long>(from); o!=g.end(); ++o, k++) {
+            glm[o->get_ind()] = w;
+            gla[o->get_ind()] = k;
         }
+    }
 }
 
-template<typename Mt>
-void Structure<Mt>::
+template<typename Mt, typename Ind>
+auto Structure<Mt, Ind>::
+edge_cl( const szt w, const szt a ) const noexcept -> szt
+{
+    if constexpr (lazy_edge_cl || Mt::coarse)
+        return mt[w].get_cl();
+    else
+        return mt[w].edge(a).get_cl();
+}
+
+template<typename Mt, typename Ind>
+auto Structure<Mt, Ind>::
+edge_indcl( const szt w, const szt a ) const noexcept -> szt
+{
+    if constexpr (!lazy_edge_cl && !Mt::coarse)
+        return mt[w].edge(a).get_indcl();
+
+    szt offset {};
+    for (const auto u : clmt[mt[w].get_cl()])
+        if (u < w)
+            offset += mt[u].length();
+
+    return offset + a;
+}
+
+template<typename Mt, typename Ind>
+auto Structure<Mt, Ind>::
+indcl_offsets() const -> std::vector<szt>
+{
+    std::vector<szt> offsets(mtnum + 1);
+    std::vector<szt> next(clnum);
+    for (szt j=1; j<=mtnum; j++) {
+        offsets[j] = next[mt[j].get_cl()];
+        next[mt[j].get_cl()] += mt[j].length();
+    }
+
+    return offsets;
+}
+
+template<typename Mt, typename Ind>
+void Structure<Mt, Ind>::
 populate_cluster_vectors() noexcept
 {
     mt11.clear();
     mtc11.resize(clnum);
-    std::fill(mtc11.begin(), mtc11.end(), undefined<szt>);
+    std::fill(mtc11.begin(), mtc11.end(), undefined<Ind>);
 
     mt22.clear();
     mtc22.resize(clnum);
-    std::fill(mtc22.begin(), mtc22.end(), undefined<szt>);
+    std::fill(mtc22.begin(), mtc22.end(), undefined<Ind>);
 
     mt33.clear();
-    mtc33.resize(clnum);
+    if (mtc33.size() < clnum) mtc33.resize(clnum);
     for (auto& o : mtc33) o.clear();
 
     mt13.clear();
-    mtc13.resize(clnum);
+    if (mtc13.size() < clnum) mtc13.resize(clnum);
     for (auto& o : mtc13) o.clear();
 
+    cls.assign(clnum, 0);
     nn = {{0}};
+    filed.assign(mtnum + 1, {});
+    pending.clear();
     clmt.resize(clnum);
     for (auto& o : clmt) o.clear();    // # of segments
-    
+    clpos.resize(mtnum + 1);
+
     for (szt j=1; j<=mtnum; j++) {
         const auto& m = mt[j];
+        clpos[j] = clmt[m.get_cl()].size();
         clmt[m.get_cl()].push_back(j);    // mitochondria indexes clusterwise
-        nn[1] += m.num_nodes(2);
-
-        const auto e = m.has_one_free_end();
-        if (e) {
-            const szt oe {e == 1 ? 2UL : 1UL};
-            nn[0]++;
-            if (m.nn[oe] == 2) {
-                const std::array<szt,2> je {j, e};
-                mtc13[m.get_cl()].emplace_back(je);   // segment index, free end index
-                mt13.emplace_back(je);
-                nn[2]++;
-            }
-        }
-        else if (m.nn[1] == 0 && m.nn[2] == 0) {
-            mtc11[m.get_cl()] = j;  // having both ends free, it is a separate segment
-            mt11.push_back(j);
-            nn[0] += 2;
-        }
-        else if (m.is_cycle()) {
-            mtc22[m.get_cl()] = j;
-            mt22.push_back(j);  // it is a separate segment since it has two free ends
+        file(j);
+    }
+    nn[2] = junctions.num(3);
+}
+
+template<typename Mt, typename Ind>
+void Structure<Mt, Ind>::
+update_cluster_vectors() noexcept
+{
+    // Vectors of the clusters that have vanished are kept until their
+    // former members are unfiled.
+    const auto n = std::max(clnum, mtc11.size());
+    mtc11.resize(n, undefined<Ind>);
+    mtc22.resize(n, undefined<Ind>);
+    if (mtc33.size() < n) mtc33.resize(n);
+    if (mtc13.size() < n) mtc13.resize(n);
+    cls.resize(n);
+    // Indexes of removed segments may exceed the current size of 'mt'.
+    for (const auto j : pending)
+        if (j >= filed.size()) {
+            filed.resize(j + 1);
+            isPending.resize(j + 1);
         }
-        else if (m.nn[1] == 2 && m.nn[2] == 2) {
-            mtc33[m.get_cl()].push_back(j);
-            mt33.push_back(j);
-            nn[2] += 2;
+
+    std::erase_if(pending, [&](const szt j) {
+        if (isPending[j]) return true;
+        isPending[j] = true;
+        unfile(j);
+        return false;
+    });
+    for (const auto j : pending) {
+        isPending[j] = false;
+        if (j <= mtnum)
+            file(j);
+    }
+    pending.clear();
+
+    // Unlike these, 'mtc33' and 'mtc13' keep their lists for reuse.
+    mtc11.resize(clnum);
+    mtc22.resize(clnum);
+    cls.resize(clnum);
+    nn[2] = junctions.num(3);
+}
+
+template<typename Mt, typename Ind>
+void Structure<Mt, Ind>::
+file( const szt j ) noexcept
+{
+    const auto& m = mt[j];
+    const auto c = m.get_cl();
+    auto& f = filed[j];
+    f = {0, c, m.length(), 0, 0, 0, m.num_nodes(2)};
+
+    const auto e = m.has_one_free_end();
+    if (e) {
+        const szt oe {e == 1 ? 2UL : 1UL};
+        f.n0 = 1;
+        if (m.nn[oe] == 2) {
+            const SegEnd je {static_cast<Ind>(j), static_cast<Ind>(e)};
+            f.kind = 4;
+            f.pos = mt13.size();
+            f.cpos = mtc13[c].size();
+            mtc13[c].emplace_back(je);   // segment index, free end index
+            mt13.emplace_back(je);
         }
-        else {
-            ; XASSERT(false,
-                      "Error in populate_cluster_vectors: failed classification for "
-                      +std::to_string(j)+"\n");
+    }
+    else if (m.nn[1] == 0 && m.nn[2] == 0) {
+        f.kind = 1;
+        f.pos = mt11.size();
+        f.n0 = 2;
+        mtc11[c] = j;  // having both ends free, it is a separate segment
+        mt11.push_back(j);
+    }
+    else if (m.is_cycle()) {
+        f.kind = 2;
+        f.pos = mt22.size();
+        mtc22[c] = j;
+        mt22.push_back(j);  // it is a separate segment since it has two free ends
+    }
+    else if (m.nn[1] == 2 && m.nn[2] == 2) {
+        f.kind = 3;
+        f.pos = mt33.size();
+        f.cpos = mtc33[c].size();
+        mtc33[c].push_back(j);
+        mt33.push_back(j);
+    }
+    else {
+        ; XASSERT(false,
+                  "Error in populate_cluster_vectors: failed classification for "
+                  +std::to_string(j)+"\n");
+    }
+    cls[c] += f.len;
+    nn[0] += f.n0;
+    nn[1] += f.n1;
+}
+
+template<typename Mt, typename Ind>
+void Structure<Mt, Ind>::
+unfile( const szt j ) noexcept
+{
+    auto& f = filed[j];
+
+    // Swap-removes position 'p' of 'v', redirecting the record of the
+    // element moved into it.
+    auto remove = [&](auto& v, const szt p, auto&& redirect) {
+        if (p + 1 != v.size()) {
+            v[p] = v.back();
+            redirect(v[p]);
         }
+        v.pop_back();
+    };
+
+    switch (f.kind) {
+        case 1:
+            if (mtc11[f.cl] == j) mtc11[f.cl] = undefined<Ind>;
+            remove(mt11, f.pos, [&](const szt o) { filed[o].pos = f.pos; });
+            break;
+        case 2:
+            if (mtc22[f.cl] == j) mtc22[f.cl] = undefined<Ind>;
+            remove(mt22, f.pos, [&](const szt o) { filed[o].pos = f.pos; });
+            break;
+        case 3:
+            remove(mt33, f.pos, [&](const szt o) { filed[o].pos = f.pos; });
+            remove(mtc33[f.cl], f.cpos,
+                   [&](const szt o) { filed[o].cpos = f.cpos; });
+            break;
+        case 4:
+            remove(mt13, f.pos,
+                   [&](const auto& o) { filed[o[0]].pos = f.pos; });
+            remove(mtc13[f.cl], f.cpos,
+                   [&](const auto& o) { filed[o[0]].cpos = f.cpos; });
+            break;
+        default:
+            break;
     }
-    nn[2] /= 3;
+    cls[f.cl] -= f.len;
+    nn[0] -= f.n0;
+    nn[1] -= f.n1;
+    f = {};
+}
+
+template<typename Mt, typename Ind>
+void Structure<Mt, Ind>::
+verify_cluster_vectors() noexcept
+{
+    const auto inc = std::make_tuple(mt11, mtc11, mt22, mtc22, mt33, mtc33,
+                                     mt13, mtc13, nn, clmt, clpos, filed,
+                                     glm, gla, cls);
+
+    auto sorted = [](auto v) {
+        std::sort(v.begin(), v.end());
+        return v;
+    };
+    auto same = [&](const auto& a, const auto& b) {
+        return sorted(a) == sorted(b);
+    };
+    auto same2 = [&](const auto& a, const auto& b) {
+        if (a.size() != b.size()) return false;
+        for (szt i=0; i<a.size(); i++)
+            if (!same(a[i], b[i])) return false;
+        return true;
+    };
+
+    make_indma();
+    populate_cluster_vectors();
+
+    if (glm != std::get<12>(inc) || gla != std::get<13>(inc) ||
+        cls != std::get<14>(inc) ||
+        !same(mt11, std::get<0>(inc)) || mtc11 != std::get<1>(inc) ||
+        !same(mt22, std::get<2>(inc)) || mtc22 != std::get<3>(inc) ||
+        !same(mt33, std::get<4>(inc)) || !same2(mtc33, std::get<5>(inc)) ||
+        !same(mt13, std::get<6>(inc)) || !same2(mtc13, std::get<7>(inc)) ||
+        nn != std::get<8>(inc))
+        msgr.exit("Error in update_cluster_vectors: "
+                  "mismatch with the full rebuild");
+
+    // Keep the incremental ordering: the full rebuild is only a check.
+    std::tie(mt11, mtc11, mt22, mtc22, mt33, mtc33,
+             mt13, mtc13, nn, clmt, clpos, filed,
+             std::ignore, std::ignore, std::ignore) = inc;
+}
+
+template<typename Mt, typename Ind>
+void Structure<Mt, Ind>::
+verify_junctions() noexcept
+{
+    szt ends3 {};
+    for (szt j=1; j<=mtnum; j++)
+        for (szt e=1; e<=2; e++) {
+            const auto& m = mt[j];
+            const auto k = junctions.at(j, e);
+            ends3 += m.nn[e] == 2;
+            if (is_defined(k) != (m.nn[e] > 0))
+                msgr.exit("Error in the junction table: linked end mismatch at "
+                          +std::to_string(j)+" "+std::to_string(e));
+            if (!m.nn[e]) continue;
+
+            bool ok = junctions[k].deg == m.nn[e] + 1 &&
+                      junctions.has(k, j, e);
+            for (szt i=1; i<=m.nn[e]; i++)
+                ok = ok && junctions.has(k, m.neig[e][i], m.neen[e][i]);
+            if (!ok)
+                msgr.exit("Error in the junction table: slot mismatch at "
+                          +std::to_string(j)+" "+std::to_string(e));
+        }
+    if (3 * junctions.num(3) != ends3)
+        msgr.exit("Error in the junction table: degree 3 node count");
 }
 
-template<typename Mt>
+template<typename Mt, typename Ind>
 template<int I>
-void Structure<Mt>::
+void Structure<Mt, Ind>::
 update_nn() noexcept
 {
     auto count_nodes = [&](const szt deg) noexcept {
@@ -276,8 +765,8 @@ update_nn() noexcept
     nn[I-1] = count_nodes(I);
 }
 
-template<typename Mt>
-void Structure<Mt>::
+template<typename Mt, typename Ind>
+void Structure<Mt, Ind>::
 update_node_numbers() noexcept
 {
     update_nn<1>();
@@ -285,16 +774,16 @@ update_node_numbers() noexcept
     update_nn<3>();
 }
 
-template<typename Mt>
-void Structure<Mt>::
+template<typename Mt, typename Ind>
+void Structure<Mt, Ind>::
 print_mitos( const std::string& tag ) const
 {
     for (szt j=1; j<=mtnum; j++)
         mt[j].print(j, tag);
     msgr.print("");
 }
-template<typename Mt>
-void Structure<Mt>::
+template<typename Mt, typename Ind>
+void Structure<Mt, Ind>::
 print( std::ostream& ofs ) const
 {
     ofs << " X ";
@@ -0,0 +1,436 @@
+/* =============================================================================
+   Copyright (C) 2015 Valerii Sukhorukov & Michael Meyer-Hermann,
+   Helmholtz Center for Infection Research (Braunschweig, Germany).
+   All Rights Reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all
+   copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+================================================================================
+*/
+
+/**
+ * @file tau_leaping.h
+ * @brief Contains the adaptive tau-leaping engine of the simulation.
+ * @author Valerii Sukhorukov
+ */
+
+#ifndef MITOSIM_TAU_LEAPING_H
+#define MITOSIM_TAU_LEAPING_H
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "definitions.h"
+
+namespace mitosim {
+
+/**
+ * @brief Interface of the reactions that can fire in batches over a leap.
+ * @details The sites of all the events of a leap are drawn first, from the
+ * state at the leap start. The events are then applied without updating
+ * the propensities, which are refreshed once for the whole leap. An event
+ * whose sites were changed by an earlier event of the leap is postponed.
+ */
+class BatchedReaction {
+
+public:
+
+    virtual ~BatchedReaction() = default;
+
+    /// Draw the sites of an event and queue it for the current leap.
+    virtual void draw_event() = 0;
+
+    /**
+     * @brief Apply a queued event, leaving the propensities as they are.
+     * @return False if the event is postponed.
+     */
+    virtual bool apply_event() = 0;
+
+    /// Refresh the propensity and the score after the events applied.
+    virtual void settle() = 0;
+};
+
+
+/**
+ * @brief Approximate engine firing the reactions in batches over time leaps.
+ * @details Over a leap, every reaction fires a Poisson-distributed number
+ * of events at the scores frozen at the leap start, in a random order.
+ * The leap is chosen so that the scores change by a relative tolerance at
+ * most: each event changes a reactant count by 2 at most, and the scores
+ * depend on the counts quadratically at most, so that K events change them
+ * by about 4K/n, for the smallest reactant count n. Reactions short of
+ * reactants (Cao et al., 2006) fire at most once per leap, and exact
+ * direct method steps are taken when a leap would be too short to pay off.
+ * If all the reactions implement BatchedReaction, the events of a leap are
+ * applied in a batch, with the propensities refreshed at the leap end, and
+ * the postponed events are then fired one by one from the refreshed state.
+ * @tparam RandFactoryT Random number factory.
+ * @tparam ReactionT Base class of the reactions.
+ */
+template<typename RandFactoryT,
+         typename ReactionT>
+class TauLeaping {
+
+public:
+
+    /// Type of the reaction scores.
+    using Score = std::remove_pointer_t<decltype(std::declval<ReactionT&>().score)>;
+
+    /// Number of reactants limiting a reaction.
+    using Pool = std::function<szt()>;
+
+    /// Reactant number below which a reaction fires at most once per leap.
+    static constexpr szt critical {10};
+
+    /// Expected number of events below which a leap is not attempted.
+    static constexpr double minEvents {10.};
+
+    /**
+     * @brief Constructor.
+     * @param rnd Random number factory.
+     * @param eps Tolerance of the relative score change over a leap.
+     */
+    explicit TauLeaping(RandFactoryT& rnd,
+                        double eps=0.03);
+
+    /**
+     * @brief Add a reaction channel.
+     * @param r The reaction.
+     * @param pool Number of reactants available to the reaction.
+     */
+    void add_reaction(std::unique_ptr<ReactionT> r,
+                      Pool pool);
+
+    /// Set the scores.
+    void initialize();
+
+    /// Sum the scores and report if any of the reactions can fire.
+    bool set_asum() noexcept;
+
+    /// Duration of the last leap or step.
+    constexpr auto tau() const noexcept { return tau_; }
+
+    /// Number of the leaps taken.
+    constexpr auto get_leaps() const noexcept { return leaps; }
+
+    /// Number of the batched events postponed to the leap end.
+    constexpr auto get_postponed() const noexcept { return numPostponed; }
+
+    /**
+     * @brief Execute a leap, or a single reaction if a leap does not pay off.
+     * @param time Current time, advanced to the end of the leap.
+     */
+    void fire(double& time);
+
+    /// Output the leap length to a log file.
+    void log_data(std::ostream& os) const;
+
+    /// Output the reaction scores to a log file.
+    void print_scores(std::ostream& os) const;
+
+private:
+
+    RandFactoryT& rnd;  ///< ref: Random number factory.
+
+    const double eps;  ///< Tolerance of the relative score change.
+
+    vup<ReactionT>    rc;    ///< The reactions.
+    std::vector<Pool> pool;  ///< Reactant numbers of the reactions.
+
+    std::vector<Score> sc;  ///< Current scores, written by the reactions.
+    std::vector<szt>   k;   ///< Events left to fire in the current leap.
+    std::vector<bool>  crit;  ///< Reaction is short of reactants.
+
+    /// The reactions as batched ones, if all of them are.
+    std::vector<BatchedReaction*> bt;
+    /// Reactions of the events postponed in the current leap.
+    std::vector<szt> postponed;
+
+    double asum {};  ///< Sum of the scores.
+    double tau_ {};  ///< Duration of the last leap or step.
+    szt leaps {};    ///< Number of the leaps taken.
+    szt numPostponed {};  ///< Number of the batched events postponed.
+
+    /**
+     * @brief Try a leap.
+     * @param time Current time, advanced if the leap is taken.
+     * @return False if the leap is too short to pay off.
+     */
+    bool leap(double& time);
+
+    /**
+     * @brief Execute a single reaction by the direct method.
+     * @param time Current time, advanced to the time of the event.
+     */
+    void step(double& time);
+
+    /// Uniform random number in [0, 1).
+    auto uniform() -> double;
+
+    /**
+     * @brief Poisson-distributed random number.
+     * @details Uses multiplication of uniforms for small means, and
+     * the transformed rejection of Hormann (1993) otherwise.
+     * @param mean Mean of the distribution.
+     */
+    auto poisson(double mean) -> szt;
+};
+
+// IMPLEMENTATION ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+template<typename RandFactoryT, typename ReactionT>
+TauLeaping<RandFactoryT, ReactionT>::
+TauLeaping(
+    RandFactoryT& rnd,
+    const double eps
+)
+    : rnd {rnd}
+    , eps {eps}
+{}
+
+
+template<typename RandFactoryT, typename ReactionT>
+void TauLeaping<RandFactoryT, ReactionT>::
+add_reaction(
+    std::unique_ptr<ReactionT> r,
+    Pool pool
+)
+{
+    rc.push_back(std::move(r));
+    this->pool.push_back(std::move(pool));
+}
+
+
+template<typename RandFactoryT, typename ReactionT>
+void TauLeaping<RandFactoryT, ReactionT>::
+initialize()
+{
+    sc.assign(rc.size(), Score {});
+    k.assign(rc.size(), 0);
+    crit.assign(rc.size(), false);
+    for (szt i=0; i<rc.size(); i++)
+        rc[i]->score = &sc[i];
+    for (auto& r : rc)
+        r->initialize_dependencies(rc);
+
+    bt.clear();
+    for (const auto& r : rc)
+        if (const auto b = dynamic_cast<BatchedReaction*>(r.get()))
+            bt.push_back(b);
+    if (bt.size() < rc.size())
+        bt.clear();
+}
+
+
+template<typename RandFactoryT, typename ReactionT>
+bool TauLeaping<RandFactoryT, ReactionT>::
+set_asum() noexcept
+{
+    asum = zero<double>;
+    for (const auto s : sc)
+        asum += s;
+
+    return asum > zero<double>;
+}
+
+
+template<typename RandFactoryT, typename ReactionT>
+void TauLeaping<RandFactoryT, ReactionT>::
+fire( double& time )
+{
+    if (!leap(time))
+        step(time);
+}
+
+
+template<typename RandFactoryT, typename ReactionT>
+bool TauLeaping<RandFactoryT, ReactionT>::
+leap( double& time )
+{
+    double ac {};  // total score of the critical reactions
+    auto nmin = huge<szt>;
+    bool any {};
+    for (szt i=0; i<rc.size(); i++) {
+        if (sc[i] <= Score {}) continue;
+        const auto n = pool[i]();
+        crit[i] = n < critical;
+        if (crit[i])
+            ac += sc[i];
+        else {
+            nmin = std::min(nmin, n);
+            any = true;
+        }
+    }
+    if (!any) return false;
+
+    const auto t1 = eps * static_cast<double>(nmin) / (4. * asum);
+    if (asum * t1 < minEvents) return false;
+
+    const auto t2 = ac > zero<double>
+                  ? -std::log(one<double> - uniform()) / ac
+                  : std::numeric_limits<double>::infinity();
+    const auto t = std::min(t1, t2);
+
+    szt total {};
+    for (szt i=0; i<rc.size(); i++) {
+        k[i] = sc[i] > Score {} && !crit[i] ? poisson(sc[i] * t) : 0;
+        total += k[i];
+    }
+    if (t2 <= t1) {
+        // One of the critical reactions, chosen in proportion to its score.
+        auto u = uniform() * ac;
+        auto c = rc.size();
+        for (szt i=0; i<rc.size(); i++)
+            if (crit[i] && sc[i] > Score {}) {
+                c = i;
+                if ((u -= sc[i]) < zero<double>) break;
+            }
+        k[c]++;
+        total++;
+    }
+
+    // Batched events are drawn all at once, from the state at the leap start.
+    const bool batched = !bt.empty();
+    if (batched)
+        for (szt i=0; i<rc.size(); i++)
+            for (szt j=0; j<k[i]; j++)
+                bt[i]->draw_event();
+
+    // The events of different reactions are interleaved at random.
+    for (; total; total--) {
+        auto r = rnd.uniform0(total);
+        szt i {};
+        while (r >= k[i])
+            r -= k[i++];
+        k[i]--;
+        if (batched) {
+            if (!bt[i]->apply_event())
+                postponed.push_back(i);
+        }
+        // The reactants may run out during the leap.
+        else if (sc[i] > Score {})
+            rc[i]->fire();
+    }
+
+    if (batched) {
+        for (const auto b : bt)
+            b->settle();
+        for (const auto i : postponed)
+            if (sc[i] > Score {})
+                rc[i]->fire();
+        numPostponed += postponed.size();
+        postponed.clear();
+    }
+
+    tau_ = t;
+    time += t;
+    leaps++;
+
+    return true;
+}
+
+
+template<typename RandFactoryT, typename ReactionT>
+void TauLeaping<RandFactoryT, ReactionT>::
+step( double& time )
+{
+    tau_ = -std::log(one<double> - uniform()) / asum;
+    time += tau_;
+
+    // The last reaction of non-zero score is taken if rounding leaves u > 0.
+    auto u = uniform() * asum;
+    auto c = rc.size();
+    for (szt i=0; i<rc.size(); i++)
+        if (sc[i] > Score {}) {
+            c = i;
+            if ((u -= sc[i]) < zero<double>) break;
+        }
+
+    rc[c]->fire();
+}
+
+
+template<typename RandFactoryT, typename ReactionT>
+auto TauLeaping<RandFactoryT, ReactionT>::
+uniform() -> double
+{
+    return static_cast<double>(rnd.uniform0(one<real>));
+}
+
+
+template<typename RandFactoryT, typename ReactionT>
+auto TauLeaping<RandFactoryT, ReactionT>::
+poisson( const double mean ) -> szt
+{
+    if (mean < 12.) {
+        const auto l = std::exp(-mean);
+        szt n {};
+        for (auto p=uniform(); p > l; p*=uniform())
+            n++;
+        return n;
+    }
+
+    const auto slam = std::sqrt(mean);
+    const auto loglam = std::log(mean);
+    const auto b = 0.931 + 2.53 * slam;
+    const auto a = -0.059 + 0.02483 * b;
+    const auto invalpha = 1.1239 + 1.1328 / (b - 3.4);
+    const auto vr = 0.9277 - 3.6224 / (b - 2.);
+
+    while (true) {
+        const auto u = uniform() - 0.5;
+        const auto v = uniform();
+        const auto us = 0.5 - std::abs(u);
+        const auto n = std::floor((2. * a / us + b) * u + mean + 0.43);
+        if (us >= 0.07 && v <= vr && n >= 0.)
+            return static_cast<szt>(n);
+        if (n < 0. || (us < 0.013 && v > us))
+            continue;
+        if (std::log(v) + std::log(invalpha) - std::log(a / (us * us) + b) <=
+            -mean + n * loglam - std::lgamma(n + 1.))
+            return static_cast<szt>(n);
+    }
+}
+
+
+template<typename RandFactoryT, typename ReactionT>
+void TauLeaping<RandFactoryT, ReactionT>::
+log_data( std::ostream& os ) const
+{
+    os << " tau " << tau_;
+}
+
+
+template<typename RandFactoryT, typename ReactionT>
+void TauLeaping<RandFactoryT, ReactionT>::
+print_scores( std::ostream& os ) const
+{
+    for (const auto s : sc)
+        os << " " << s;
+}
+
+}  // namespace mitosim
+
+#endif  // MITOSIM_TAU_LEAPING_H
@@ -1,7 +1,9 @@
 #include <algorithm>
+#include <array>
 #include <filesystem>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -31,12 +33,17 @@ public:
     using AbilityForFusion::fuse_to_loop;
     using AbilityForFusion::gla;
     using AbilityForFusion::glm;
+    using AbilityForFusion::handles;
+    using AbilityForFusion::junctions;
+    using AbilityForFusion::mt22;
+    using AbilityForFusion::nn;
     using AbilityForFusion::mt;
     using AbilityForFusion::mtnum;
     using AbilityForFusion::rename_mito;
     using AbilityForFusion::update_neigs;
     using AbilityForFission::fiss2;
     using AbilityForFission::fiss3;
+    using AbilityForFission::update_structure;
 
     AF(Msgr* msgr) : AbilityForFusion {*msgr} {}
 };
@@ -113,8 +120,8 @@ TEST_F(AbilityFissionTest, Fiss2)
             const auto& m = ct.mt[j];
             ASSERT_EQ(m.get_cl(), j - 1);
             for (szt i=0; i<m.g.size(); i++) {
-                ASSERT_EQ(m.g[i].get_cl(), m.get_cl());
-                ASSERT_EQ(m.g[i].get_indcl(), i);
+                ASSERT_EQ(ct.edge_cl(j, i), m.get_cl());
+                ASSERT_EQ(ct.edge_indcl(j, i), i);
                 ASSERT_EQ(m.g[i].get_ind(), c++);
             }
             ASSERT_EQ(m.nn[1], 0);
@@ -154,10 +161,10 @@ TEST_F(AbilityFissionTest, Fiss3a)
 
     for (szt c=0, j=1; j<=ct.mtnum; j++) {
         const auto& m = ct.mt[j];
-        ASSERT_EQ(m.get_cl(), j - 1);
+        ASSERT_EQ(m.get_cl(), ct.clnum - j);
         for (szt i=0; i<m.g.size(); i++) {
-            ASSERT_EQ(m.g[i].get_cl(), m.get_cl());
-            ASSERT_EQ(m.g[i].get_indcl(), i);
+            ASSERT_EQ(ct.edge_cl(j, i), m.get_cl());
+            ASSERT_EQ(ct.edge_indcl(j, i), i);
             ASSERT_EQ(m.g[i].get_ind(), c++);
         }
         ASSERT_EQ(m.nn[1], 0);
@@ -195,14 +202,14 @@ TEST_F(AbilityFissionTest, Fiss3b)
     ASSERT_EQ(ct.mt[1].g.size(), len[0] + a);
     ASSERT_EQ(ct.mt[2].g.size(), len[1] - a);
 
-    ASSERT_EQ(ct.mt[1].get_cl(), 1);
-    ASSERT_EQ(ct.mt[2].get_cl(), 0);
+    ASSERT_EQ(ct.mt[1].get_cl(), 0);
+    ASSERT_EQ(ct.mt[2].get_cl(), 1);
 
     for (szt c=0, j=ct.mtnum; j<0; j--) {
         const auto& m = ct.mt[j];
         for (szt i=0; i<m.g.size(); i++) {
-            ASSERT_EQ(m.g[i].get_cl(), m.get_cl());
-            ASSERT_EQ(m.g[i].get_indcl(), i);
+            ASSERT_EQ(ct.edge_cl(j, i), m.get_cl());
+            ASSERT_EQ(ct.edge_indcl(j, i), i);
             ASSERT_EQ(m.g[i].get_ind(), c++);
         }
         ASSERT_EQ(m.nn[1], 0);
@@ -231,8 +238,8 @@ TEST_F(AbilityFissionTest, Fiss3c)
     ASSERT_EQ(m.g.size(), len);
     ASSERT_EQ(m.get_cl(), 0);
     for (szt i=0; i<m.g.size(); i++) {
-        ASSERT_EQ(m.g[i].get_cl(), m.get_cl());
-        ASSERT_EQ(m.g[i].get_indcl(), i);
+        ASSERT_EQ(ct.edge_cl(1, i), m.get_cl());
+        ASSERT_EQ(ct.edge_indcl(1, i), i);
         ASSERT_EQ(m.g[i].get_ind(), i);
     }
     ASSERT_EQ(m.nn[1], 0);
@@ -261,8 +268,8 @@ TEST_F(AbilityFissionTest, Fiss3d)
     ASSERT_EQ(m.g.size(), len);
     ASSERT_EQ(m.get_cl(), 0);
     for (szt i=0; i<m.g.size(); i++) {
-        ASSERT_EQ(m.g[i].get_cl(), m.get_cl());
-        ASSERT_EQ(m.g[i].get_indcl(), i);
+        ASSERT_EQ(ct.edge_cl(1, i), m.get_cl());
+        ASSERT_EQ(ct.edge_indcl(1, i), i);
         if (i < a)
             ASSERT_EQ(m.g[i].get_ind(), a - 1 - i);
         else
@@ -308,13 +315,225 @@ TEST_F(AbilityFissionTest, Fiss3e)
 
     for (szt c=0, j=1; j<=ct.mtnum; j++) {
         const auto& x = ct.mt[j];
-        ASSERT_EQ(x.get_cl(), ct.clnum - j);
+        ASSERT_EQ(x.get_cl(), j - 1);
         for (szt i=0; i<x.g.size(); i++) {
-            ASSERT_EQ(x.g[i].get_cl(), x.get_cl());
-            ASSERT_EQ(x.g[i].get_indcl(), i);
+            ASSERT_EQ(ct.edge_cl(j, i), x.get_cl());
+            ASSERT_EQ(ct.edge_indcl(j, i), i);
             ASSERT_EQ(x.g[i].get_ind(), c++);
         }
     }
 }
 
+TEST_F(AbilityFissionTest, ClusterMembers)
+{
+    // Tests that the cluster member lists follow the transformations,
+    // and that Edge::indcl is ordered by segment index.
+    AF ct {&msgr};
+    for (szt i=0; i<6; i++)
+        ct.add_disconnected_segment(4);
+
+    const auto check = [&]() {
+        for (szt c=0; c<ct.clmt.size(); c++) {
+            std::vector<mitosim::Index> m;
+            for (szt i=1; i<=ct.mtnum; i++)
+                if (ct.mt[i].get_cl() == c)
+                    m.push_back(i);
+            auto l = ct.clmt[c];
+            std::sort(l.begin(), l.end());
+            EXPECT_EQ(l, m);
+            for (szt k=0; k<ct.clmt[c].size(); k++)
+                EXPECT_EQ(ct.clpos[ct.clmt[c][k]], k);
+            szt indcl {};
+            const auto offsets = ct.indcl_offsets();
+            for (const auto i : m) {
+                EXPECT_EQ(offsets[i], indcl);
+                for (szt a=0; a<ct.mt[i].g.size(); a++)
+                    EXPECT_EQ(ct.edge_indcl(i, a), indcl++);
+            }
+        }
+        EXPECT_GE(ct.clmt.size(), ct.clnum);
+    };
+
+    check();
+    ct.fuse12(1, 1, 2, 2);
+    check();
+    ct.fuse11(3, 2, 4, 1);
+    check();
+    ct.fuse11(5, 1, 6, 1);
+    check();
+    ct.fuse12(4, 2, 1, 2);
+    check();
+    ct.fuse_to_loop(5);
+    ct.fuse1L(4, 1, 5);
+    check();
+    ct.update_structure();
+    ct.fiss2(4, 3);
+    check();
+    EXPECT_EQ(ct.clnum, 2);
+}
+
+TEST_F(AbilityFissionTest, IncrementalStructure)
+{
+    // Tests that the incremental update of the class vectors and
+    // the edge maps agrees with the full rebuild.
+    if constexpr (!mitosim::incremental_structure)
+        GTEST_SKIP() << "The class vectors are rebuilt in full instead.";
+
+    AF ct {&msgr};
+    for (szt i=0; i<6; i++)
+        ct.add_disconnected_segment(4);
+
+    const auto check = [&]() {
+        ct.update_cluster_vectors();
+        auto sorted = [](auto v) { std::sort(v.begin(), v.end()); return v; };
+        const auto mt11 = sorted(ct.mt11);
+        const auto mt22 = sorted(ct.mt22);
+        const auto mt33 = sorted(ct.mt33);
+        const auto mt13 = sorted(ct.mt13);
+        const auto mtc11 = ct.mtc11;
+        const auto mtc22 = ct.mtc22;
+        auto mtc33 = ct.mtc33;
+        for (auto& o : mtc33) o = sorted(o);
+        auto mtc13 = ct.mtc13;
+        for (auto& o : mtc13) o = sorted(o);
+        const auto nn = ct.nn;
+        const auto cls = ct.cls;
+        const auto glm = ct.glm;
+        const auto gla = ct.gla;
+
+        ct.make_indma();
+        ct.populate_cluster_vectors();
+        EXPECT_EQ(mt11, ct.mt11);
+        EXPECT_EQ(mt22, ct.mt22);
+        EXPECT_EQ(mt33, ct.mt33);
+        EXPECT_EQ(mt13, ct.mt13);
+        EXPECT_EQ(mtc11, ct.mtc11);
+        EXPECT_EQ(mtc22, ct.mtc22);
+        EXPECT_EQ(mtc33, ct.mtc33);
+        EXPECT_EQ(mtc13, ct.mtc13);
+        EXPECT_EQ(nn, ct.nn);
+        EXPECT_EQ(cls, ct.cls);
+        EXPECT_EQ(glm, ct.glm);
+        EXPECT_EQ(gla, ct.gla);
+    };
+
+    check();
+    ct.fuse12(1, 1, 2, 2);
+    check();
+    ct.fuse11(3, 2, 4, 1);
+    ct.fuse11(5, 1, 6, 1);
+    check();
+    ct.fuse12(4, 2, 1, 2);
+    check();
+    ct.fuse_to_loop(5);
+    check();
+    ct.fuse1L(4, 1, 5);
+    check();
+    ct.fiss2(4, 3);
+    check();
+    ASSERT_FALSE(ct.mt13.empty());
+    const auto [w, e] = ct.mt13[0];
+    ct.fiss3(w, e == 1 ? 2 : 1);
+    check();
+}
+
+TEST_F(AbilityFissionTest, Handles)
+{
+    // Tests that the segment handles follow the segments renumbered
+    // by the transformations and expire with the vanishing ones.
+    AF ct {&msgr};
+    for (szt i=0; i<6; i++)
+        ct.add_disconnected_segment(4);
+
+    const auto h1 = ct.handles.handle(1);
+    const auto h2 = ct.handles.handle(2);
+    const auto h6 = ct.handles.handle(6);
+    const auto e6 = ct.mt[6].edge(0).get_ind();
+
+    // Segment 6 stays a bystander: k-th of the other segments.
+    const auto o = [&](const szt k) {
+        return k < ct.handles.index(h6) ? k : k + 1;
+    };
+
+    const auto check = [&]() {
+        ct.update_structure();
+        EXPECT_EQ(ct.handles.size(), ct.mtnum);
+        for (szt w=1; w<=ct.mtnum; w++)
+            EXPECT_EQ(ct.handles.index(ct.handles.handle(w)), w);
+        ASSERT_TRUE(ct.handles.contains(h6));
+        EXPECT_EQ(ct.mt[ct.handles.index(h6)].edge(0).get_ind(), e6);
+    };
+
+    ct.fuse11(1, 2, 2, 1);
+    EXPECT_NE(ct.handles.contains(h1), ct.handles.contains(h2));
+    check();
+    EXPECT_NE(ct.handles.index(h6), 6);
+    ct.fuse11(o(2), 1, o(3), 1);
+    check();
+    ct.fiss2(o(1), 3);
+    check();
+    ct.fuse12(o(4), 2, o(1), 2);
+    check();
+    ASSERT_FALSE(ct.mt13.empty());
+    const auto [w, e] = ct.mt13[0];
+    ct.fiss3(w, e == 1 ? 2 : 1);
+    check();
+}
+
+TEST_F(AbilityFissionTest, Junctions)
+{
+    // Tests that the transformations keep the node table current as the
+    // junctions form and vanish, retaining the ids of the nodes unaffected.
+    AF ct {&msgr};
+    for (szt i=0; i<6; i++)
+        ct.add_disconnected_segment(4);
+    EXPECT_EQ(ct.junctions.num(3), 0);
+    EXPECT_FALSE(mitosim::is_defined(ct.junctions.at(1, 1)));
+
+    using SE = std::array<mitosim::Index,2>;
+    auto slots = [&](const szt w, const szt e) {
+        const auto& n = ct.junctions[ct.junctions.at(w, e)];
+        std::vector<SE> s(n.slots.begin(), n.slots.begin() + n.deg);
+        std::sort(s.begin(), s.end());
+        return s;
+    };
+
+    ct.fuse12(1, 1, 2, 2);  // segment 2 is split into 2 and 7
+    EXPECT_EQ(ct.junctions.num(3), 1);
+    EXPECT_EQ(slots(1, 1), (std::vector<SE> {{1, 1}, {2, 2}, {7, 1}}));
+    const auto k = ct.junctions.at(1, 1);
+    EXPECT_EQ(ct.junctions.at(2, 2), k);
+    EXPECT_EQ(ct.junctions.at(7, 1), k);
+    ct.update_structure();
+    EXPECT_EQ(ct.nn[2], 1);
+
+    ct.fuse_to_loop(6);
+    EXPECT_EQ(ct.junctions.num(2), 1);
+    EXPECT_EQ(slots(6, 1), (std::vector<SE> {{6, 1}, {6, 2}}));
+
+    ct.fuse11(3, 2, 4, 1);  // segment 3 vanishes, 7 is renamed to 3
+    EXPECT_EQ(ct.junctions.at(1, 1), k);
+    EXPECT_EQ(slots(1, 1), (std::vector<SE> {{1, 1}, {2, 2}, {3, 1}}));
+    EXPECT_FALSE(mitosim::is_defined(ct.junctions.at(7, 1)));
+
+    ct.fuse1L(5, 2, 6);
+    EXPECT_EQ(ct.junctions.num(3), 2);
+    EXPECT_EQ(ct.junctions.num(2), 0);
+    EXPECT_EQ(slots(5, 2), (std::vector<SE> {{5, 2}, {6, 1}, {6, 2}}));
+    ct.update_structure();
+    EXPECT_EQ(ct.nn[2], 2);
+
+    const auto k5 = ct.junctions.at(5, 2);
+    ct.fiss3(1, 1);         // segments 2 and 3 are fused
+    EXPECT_EQ(ct.junctions.num(3), 1);
+    EXPECT_EQ(ct.junctions.at(5, 2), k5);
+    szt linked {};
+    for (szt w=1; w<=ct.mtnum; w++)
+        for (szt e=1; e<=2; e++)
+            linked += mitosim::is_defined(ct.junctions.at(w, e));
+    EXPECT_EQ(linked, 3);
+    ct.update_structure();
+    EXPECT_EQ(ct.nn[2], 1);
+}
+
 }  // namespace ability_fission_test
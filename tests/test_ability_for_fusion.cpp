@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <array>
 #include <filesystem>
 #include <memory>
 #include <string>
@@ -110,25 +111,25 @@ TEST_F(AbilityFusionTest, Fuse12a)
 
         for (szt i=0; i<ct.mt.size(); i++) {
             ASSERT_EQ(ct.mt[i].get_cl(), 0);
-            for (const auto& g : ct.mt[i].g)
-                ASSERT_EQ(g.get_cl(), ct.mt[i].get_cl());
+            for (szt a=0; a<ct.mt[i].g.size(); a++)
+                ASSERT_EQ(ct.edge_cl(i, a), ct.mt[i].get_cl());
         }
 
         szt indcl {};
         ASSERT_EQ(ct.mt[w2].g.size(), a);
         for (szt i=0; i<ct.mt[w2].g.size(); i++) {
-            ASSERT_EQ(ct.mt[w2].g[i].get_indcl(), indcl++);
+            ASSERT_EQ(ct.edge_indcl(w2, i), indcl++);
             ASSERT_EQ(ct.mt[w2].g[i].get_ind(), i);
         }
         ASSERT_EQ(ct.mt[w1].g.size(), len[w1-1]);
         for (szt i=0; i<ct.mt[w1].g.size(); i++) {
-            ASSERT_EQ(ct.mt[w1].g[i].get_indcl(), indcl++);
+            ASSERT_EQ(ct.edge_indcl(w1, i), indcl++);
             ASSERT_EQ(ct.mt[w1].g[i].get_ind(),
                       i + ct.mt[w2].g.size() + ct.mt.back().g.size());
         }
         ASSERT_EQ(ct.mt.back().g.size(), len[w2-1] - a);
         for (szt i=0; i<ct.mt.back().g.size(); i++) {
-            ASSERT_EQ(ct.mt.back().g[i].get_indcl(), indcl++);
+            ASSERT_EQ(ct.edge_indcl(ct.mtnum, i), indcl++);
             ASSERT_EQ(ct.mt.back().g[i].get_ind(),
                       i + ct.mt[w2].g.size());
         }
@@ -183,19 +184,19 @@ TEST_F(AbilityFusionTest, Fuse12b)
 
             for (szt i=0; i<ct.mt.size(); i++) {
                 ASSERT_EQ(ct.mt[i].get_cl(), 0);
-                for (const auto& g : ct.mt[i].g)
-                    ASSERT_EQ(g.get_cl(), ct.mt[i].get_cl());
+                for (szt a=0; a<ct.mt[i].g.size(); a++)
+                    ASSERT_EQ(ct.edge_cl(i, a), ct.mt[i].get_cl());
             }
 
             szt indcl {};
             ASSERT_EQ(ct.mt[w].g.size(), a);
             for (szt i=0; i<ct.mt[w].g.size(); i++) {
-                ASSERT_EQ(ct.mt[w].g[i].get_indcl(), indcl++);
+                ASSERT_EQ(ct.edge_indcl(w, i), indcl++);
                 ASSERT_EQ(ct.mt[w].g[i].get_ind(), i);
             }
             ASSERT_EQ(ct.mt[v].g.size(), len - a);
             for (szt i=0; i<ct.mt[v].g.size(); i++) {
-                ASSERT_EQ(ct.mt[v].g[i].get_indcl(), indcl++);
+                ASSERT_EQ(ct.edge_indcl(v, i), indcl++);
                 ASSERT_EQ(ct.mt[v].g[i].get_ind(),
                           i + ct.mt[w].g.size());
             }
@@ -277,13 +278,13 @@ TEST_F(AbilityFusionTest, Fuse12c)
         std::iota(t.begin(), t.end(), 0);
         std::rotate(t.begin(), t.begin() + a, t.end());
         for (szt i=0; i<ct.mt[w2].g.size(); i++) {
-            ASSERT_EQ(ct.mt[w2].g[i].get_indcl(), c);
+            ASSERT_EQ(ct.edge_indcl(w2, i), c);
             ASSERT_EQ(ct.mt[w2].g[i].get_ind(), t[i]);
             c++;
         }
-        for (const auto& g : ct.mt[w1].g) {
-            ASSERT_EQ(g.get_indcl(), c);
-            ASSERT_EQ(g.get_ind(), c);
+        for (szt i=0; i<ct.mt[w1].g.size(); i++) {
+            ASSERT_EQ(ct.edge_indcl(w1, i), c);
+            ASSERT_EQ(ct.mt[w1].g[i].get_ind(), c);
             c++;
         }
 
@@ -343,13 +344,13 @@ TEST_F(AbilityFusionTest, Fuse1L)
     std::iota(v.begin(), v.end(), 0);
     std::rotate(v.begin(), v.begin()+0, v.end());
     for (szt i=0; i<ct.mt[w2].g.size(); i++) {
-        ASSERT_EQ(ct.mt[w2].g[i].get_indcl(), c);
+        ASSERT_EQ(ct.edge_indcl(w2, i), c);
         ASSERT_EQ(ct.mt[w2].g[i].get_ind(), v[i]);
         c++;
     }
-    for (const auto& g : ct.mt[w1].g) {
-        ASSERT_EQ(g.get_indcl(), c);
-        ASSERT_EQ(g.get_ind(), c);
+    for (szt i=0; i<ct.mt[w1].g.size(); i++) {
+        ASSERT_EQ(ct.edge_indcl(w1, i), c);
+        ASSERT_EQ(ct.mt[w1].g[i].get_ind(), c);
         c++;
     }
 
@@ -372,4 +373,28 @@ TEST_F(AbilityFusionTest, Fuse1L)
     ASSERT_EQ(ct.mt[w2].neen[2][2], e);
 }
 
+TEST_F(AbilityFusionTest, SmallerClusterRelabelled)
+{
+    // Fusion of a single segment to the middle of another one: the component
+    // of the former is the smaller one, so it is relabelled, and the last
+    // component takes its index.
+    constexpr std::array<szt,4> len {4, 4, 4, 4};
+
+    AF ct {msgr};
+    for (const auto u : len)
+        ct.add_disconnected_segment(u);
+
+    const auto cc = ct.fuse12(3, 1, 2, 2);
+
+    ASSERT_EQ(ct.mtnum, 5);
+    ASSERT_EQ(ct.clnum, 3);
+    ASSERT_EQ(cc, (std::array<szt,2> {1, 2}));
+
+    ASSERT_EQ(ct.mt[1].get_cl(), 0);
+    ASSERT_EQ(ct.mt[2].get_cl(), 1);
+    ASSERT_EQ(ct.mt[3].get_cl(), 1);
+    ASSERT_EQ(ct.mt[5].get_cl(), 1);
+    ASSERT_EQ(ct.mt[4].get_cl(), 2);
+}
+
 }  // namespace ability_fusion_test
@@ -0,0 +1,342 @@
+/* =============================================================================
+   Copyright (C) 2015 Valerii Sukhorukov & Michael Meyer-Hermann,
+   Helmholtz Center for Infection Research (Braunschweig, Germany).
+   All Rights Reserved.
+
+   Permission is hereby granted, free of charge, to any person obtaining a copy
+   of this software and associated documentation files (the "Software"), to deal
+   in the Software without restriction, including without limitation the rights
+   to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+   copies of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be included in all
+   copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+================================================================================
+*/
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <ostream>
+#include <string>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+#include "../config.h"
+#include "../definitions.h"
+#include "../segment.h"
+#include "../ability_for_fusion.h"
+#include "../network.h"
+#include "../simulation.h"
+
+// Test-only hooks on the global operator new and delete. Besides counting
+// the calls, they tell the blocks freed within the iteration that
+// allocated them, unless they are replaced as a container grows: such blocks
+// are temporaries. The replacement is the larger block allocated by
+// the heap call preceding the release, as when a vector relocates
+// its elements, and it replaces a single block.
+namespace {
+
+std::size_t allocations {};
+
+const unsigned long* iteration {};  // Tracked iteration counter, if any.
+
+unsigned long current {};  // Iteration the recorded blocks belong to.
+std::array<std::pair<void*,std::size_t>,256> fresh {};
+std::size_t numFresh {};
+std::size_t latest {};  // 1 + index of the block allocated by the last call.
+
+std::array<unsigned long,64> temporaryAt {};  // Iterations with temporaries.
+std::size_t numTemporary {};
+
+void note_new( void* p, const std::size_t n ) noexcept
+{
+    allocations++;
+    latest = 0;
+    if (!iteration) return;
+    if (*iteration != current) {
+        current = *iteration;
+        numFresh = 0;
+    }
+    if (numFresh < fresh.size()) {
+        fresh[numFresh++] = {p, n};
+        latest = numFresh;
+    }
+}
+
+void note_delete( void* p ) noexcept
+{
+    const auto replacement = std::exchange(latest, 0);
+
+    // Iteration 0 precedes the first event.
+    if (!iteration || !current || *iteration != current) return;
+    for (std::size_t i=0; i<numFresh; i++)
+        if (fresh[i].first == p) {
+            fresh[i].first = nullptr;
+            if (replacement &&
+                fresh[replacement-1].second > fresh[i].second)
+                return;
+            if (numTemporary < temporaryAt.size())
+                temporaryAt[numTemporary] = current;
+            numTemporary++;
+            return;
+        }
+}
+
+}  // namespace
+
+void* operator new( std::size_t n )
+{
+    if (void* p = std::malloc(n ? n : 1)) {
+        note_new(p, n);
+        return p;
+    }
+    throw std::bad_alloc {};
+}
+
+// The replacements pair malloc() with free() themselves.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete( void* p ) noexcept { note_delete(p); std::free(p); }
+void operator delete( void* p, std::size_t ) noexcept
+{
+    note_delete(p);
+    std::free(p);
+}
+
+namespace allocations_test {
+
+// Subclass to make protected members accessible for testing:
+class AF
+    : public mitosim::AbilityForFusion<mitosim::Segment<3>> {
+
+public:
+
+    using Msgr = mitosim::Msgr;
+    using Mt = mitosim::Segment<3>;
+    using AbilityForFusion = mitosim::AbilityForFusion<Mt>;
+
+    using AbilityForFusion::clnum;
+    using AbilityForFusion::fiss2;
+    using AbilityForFusion::mt;
+    using AbilityForFusion::mtnum;
+    using AbilityForFusion::update_structure;
+
+    AF(Msgr* msgr) : AbilityForFusion {*msgr} {}
+};
+
+class AllocationsTest
+    : public testing::Test {
+
+protected:
+
+    using Msgr = mitosim::Msgr;
+    using Mt = mitosim::Segment<3>;
+    using Network = mitosim::Network<Mt>;
+    using real = mitosim::real;
+    using szt = mitosim::szt;
+
+    const std::string workingDir {std::filesystem::current_path()
+                                  / "tests" / "data/"};
+    const std::string fnameSuffix {"sample"};
+    const std::string runName {"42"};
+
+    AllocationsTest()
+        : msgr {}
+        , conf {workingDir, fnameSuffix, runName, msgr}
+    {}
+
+    mitosim::Msgr msgr;
+    mitosim::Config<real> conf;
+};
+
+TEST_F(AllocationsTest, RecurrentTransformations)
+{
+    if constexpr (!mitosim::incremental_structure ||
+                  mitosim::verify_structure)
+        GTEST_SKIP() << "Full structure rebuilds allocate.";
+
+    // Tests that transformations returning the network to a state
+    // it has been in allocate nothing once the storage has been grown.
+    AF t {&msgr};
+    for (szt i=0; i<3; i++)
+        t.add_disconnected_segment(10);
+    t.update_structure();
+
+    // fiss2 and fuse11 rejoining the cut; fuse12 and fiss3 undoing it.
+    const auto cycle = [&t] {
+        t.fiss2(1, 5);
+        t.update_structure();
+        t.fuse11(1, 2, 4, 1);
+        t.update_structure();
+        t.fuse12(2, 2, 3, 5);
+        t.update_structure();
+        t.fiss3(2, 2);
+        t.update_structure();
+        t.touched.clear();
+    };
+
+    for (szt i=0; i<4; i++)
+        cycle();
+
+    const auto a0 = allocations;
+    for (szt i=0; i<100; i++)
+        cycle();
+
+    EXPECT_EQ(allocations - a0, 0);
+    EXPECT_EQ(t.mtnum, 3);
+    EXPECT_EQ(t.clnum, 3);
+    for (szt w=1; w<=t.mtnum; w++)
+        EXPECT_EQ(t.mt[w].g.size(), 10);
+}
+
+/**
+ * @brief Engine attributing the allocations to the reaction types.
+ * @details Past the warm-up, counts the events of every reaction, and
+ * the allocations made and the events allocating.
+ * @tparam EngineT Engine counted.
+ */
+template<typename EngineT>
+class CountingEngine
+    : public EngineT {
+
+public:
+
+    using Reaction = utils::stochastic::Reaction<mitosim::RandFactory>;
+
+    static constexpr std::array<const char*,4> names {
+        "fission", "fusion11", "fusion12", "fusion1L"
+    };
+
+    static inline unsigned long warmup {};  ///< Events of the warm-up.
+    static inline unsigned long events {};  ///< Events fired.
+
+    // Per reaction, past the warm-up:
+    static inline std::array<std::size_t,4> fired {};       ///< Events.
+    static inline std::array<std::size_t,4> allocated {};   ///< Allocations.
+    static inline std::array<std::size_t,4> allocating {};  ///< Events allocating.
+
+    explicit CountingEngine(mitosim::RandFactory& rnd)
+        : EngineT {rnd}
+    {
+        events = 0;
+        fired = allocated = allocating = {};
+    }
+
+    template<typename R, typename... Pool>
+        requires requires (EngineT& e, std::unique_ptr<R> r, Pool... pool) {
+            e.add_reaction(std::move(r), pool...);
+        }
+    void add_reaction(std::unique_ptr<R> r, Pool... pool)
+    {
+        rc[num++] = r.get();
+        EngineT::add_reaction(std::move(r), std::move(pool)...);
+    }
+
+    void fire(double& time)
+    {
+        std::array<unsigned long,4> before {};
+        for (std::size_t k=0; k<num; k++)
+            before[k] = rc[k]->eventCount;
+        const auto a0 = allocations;
+
+        EngineT::fire(time);
+
+        if (++events <= warmup) return;
+        const auto a = allocations - a0;
+        for (std::size_t k=0; k<num; k++)
+            if (rc[k]->eventCount != before[k]) {
+                fired[k]++;
+                allocated[k] += a;
+                allocating[k] += a > 0;
+            }
+    }
+
+private:
+
+    std::array<Reaction*,4> rc {};
+    std::size_t num {};
+};
+
+TEST_F(AllocationsTest, SteadyState)
+{
+    if constexpr (!mitosim::incremental_structure ||
+                  mitosim::verify_structure)
+        GTEST_SKIP() << "Full structure rebuilds allocate.";
+
+    // Tests that, run by Simulation, the reaction events allocate
+    // no temporaries, and reports the allocations per event type.
+    // The only source of allocations left is the growth of the storage
+    // retained by the network as the segment numbers, cluster numbers and
+    // segment lengths reach new highs; it grows ever rarer, but does not
+    // stop. The contract is thus: after the warm-up, no temporaries, and
+    // at most 1% of the events of every type allocating.
+    // The setup and the output, at the final iteration only,
+    // are not checked.
+    using Engine = CountingEngine<mitosim::ReactionEngine>;
+    constexpr unsigned long warmupEvents {20000};
+
+    // The sample configuration, with the periodic output turned off.
+    const auto dir = std::filesystem::temp_directory_path()
+                   / "mitosim_allocations_test";
+    std::filesystem::create_directories(dir);
+    {
+        std::ifstream ifs {workingDir + "config_" + fnameSuffix + ".txt"};
+        std::ofstream ofs {dir / "config_steady.txt"};
+        for (std::string line; std::getline(ifs, line); ) {
+            if (line.starts_with("logFrequency") ||
+                line.starts_with("saveFrequency"))
+                line = line.substr(0, line.find('=')) + "= 1000000000";
+            ofs << line << "\n";
+        }
+    }
+    std::ostream sink {nullptr};
+    Msgr quiet {&sink, &sink, 6};
+    const mitosim::Config<real> cfg {dir, "steady", runName, quiet};
+
+    mitosim::RandFactory rf {10, quiet};
+    Network ntw {cfg, rf, quiet};
+    ntw.assemble();
+
+    Engine::warmup = warmupEvents;
+    iteration = &ntw.it;
+    mitosim::Simulation<Network, Engine> {ntw, rf, ntw.time, ntw.it, quiet}
+        .initialize()();
+    iteration = nullptr;
+    const auto last = ntw.it;
+
+    for (std::size_t k=0; k<std::min(numTemporary, temporaryAt.size()); k++)
+        EXPECT_EQ(temporaryAt[k], last) << "Temporary at iteration "
+                                        << temporaryAt[k];
+
+    ASSERT_GT(Engine::events, 2 * warmupEvents);
+    for (std::size_t k=0; k<Engine::names.size(); k++) {
+        std::cout << Engine::names[k] << ": " << Engine::fired[k]
+                  << " events, " << Engine::allocated[k]
+                  << " allocations in " << Engine::allocating[k]
+                  << " events" << std::endl;
+        EXPECT_LE(100 * Engine::allocating[k], Engine::fired[k]);
+    }
+    EXPECT_GT(Engine::fired[0], 0);
+
+    std::filesystem::remove_all(dir);
+}
+
+}  // namespace allocations_test
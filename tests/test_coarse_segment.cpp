@@ -0,0 +1,94 @@
+#include "gtest/gtest.h"
+
+#include "../definitions.h"
+#include "../coarse_segment.h"
+
+namespace coarse_segment_test {
+
+class CoarseSegmentTest
+    : public testing::Test {
+
+protected:
+
+    using Msgr = mitosim::Msgr;
+    using Segment = mitosim::CoarseSegment<3>;
+    using szt = mitosim::szt;
+
+    static constexpr szt segmass = 10;
+    static constexpr szt cl = 34;
+    static constexpr szt ei0 = 8;
+
+    Msgr msgr;
+};
+
+TEST_F(CoarseSegmentTest, Constructor)
+{
+    const Segment sg {segmass, cl, ei0, msgr};
+
+    EXPECT_EQ(sg.length(), segmass);
+    EXPECT_EQ(sg.get_cl(), cl);
+    EXPECT_EQ(sg.nn[1], 0);
+    EXPECT_EQ(sg.nn[2], 0);
+    ASSERT_FALSE(sg.is_reversed());
+}
+
+TEST_F(CoarseSegmentTest, SplitG)
+{
+    Segment sg {segmass, cl, ei0, msgr};
+    Segment o {msgr};
+
+    sg.split_g(3, o);
+
+    EXPECT_EQ(sg.length(), 3);
+    EXPECT_EQ(o.length(), segmass - 3);
+}
+
+TEST_F(CoarseSegmentTest, AppendG)
+{
+    Segment sg {segmass, cl, ei0, msgr};
+    Segment o {4, cl, ei0, msgr};
+
+    sg.append_g(o);
+
+    EXPECT_EQ(sg.length(), segmass + 4);
+    EXPECT_EQ(o.length(), 0);
+}
+
+TEST_F(CoarseSegmentTest, TakeG)
+{
+    Segment sg {msgr};
+    Segment o {segmass, cl, ei0, msgr};
+
+    sg.take_g(o);
+
+    EXPECT_EQ(sg.length(), segmass);
+    EXPECT_EQ(o.length(), 0);
+}
+
+TEST_F(CoarseSegmentTest, SetCl)
+{
+    Segment sg {segmass, cl, ei0, msgr};
+
+    EXPECT_EQ(sg.setCl(5, 7), 7 + segmass);
+    EXPECT_EQ(sg.get_cl(), 5);
+}
+
+TEST_F(CoarseSegmentTest, NumNodes)
+{
+    Segment sg {segmass, cl, ei0, msgr};
+
+    EXPECT_EQ(sg.num_nodes(1), 2);
+    EXPECT_EQ(sg.num_nodes(2), segmass - 1);
+    EXPECT_EQ(sg.num_nodes(3), 0);
+
+    // Looped onto itself.
+    sg.nn[1] = sg.nn[2] = 1;
+    sg.neig[1][1] = sg.neig[2][1] = 1;
+    sg.neen[1][1] = 2;
+    sg.neen[2][1] = 1;
+    ASSERT_TRUE(sg.is_cycle());
+    EXPECT_EQ(sg.num_nodes(1), 0);
+    EXPECT_EQ(sg.num_nodes(2), segmass);
+}
+
+}  // namespace coarse_segment_test
@@ -166,8 +166,8 @@ TEST_F(CoreTransformerTest, FuseAntiparE2)
                     else    // not affected
                         ASSERT_EQ(ct.mt[i].g.size(), len[i-1]);
 
-                    for (const auto& gg : ct.mt[i].g)
-                        ASSERT_EQ(gg.get_cl(), ct.mt[i].get_cl());
+                    for (szt a=0; a<ct.mt[i].g.size(); a++)
+                        ASSERT_EQ(ct.edge_cl(i, a), ct.mt[i].get_cl());
                 }
 
                 int c {};
@@ -232,8 +232,8 @@ TEST_F(CoreTransformerTest, FuseParallel)
                     else    // not affected
                         ASSERT_EQ(ct.mt[i].g.size(), len[i-1]);
 
-                    for (const auto& gg : ct.mt[i].g)
-                        ASSERT_EQ(gg.get_cl(), ct.mt[i].get_cl());
+                    for (szt a=0; a<ct.mt[i].g.size(); a++)
+                        ASSERT_EQ(ct.edge_cl(i, a), ct.mt[i].get_cl());
                 }
 
                 for (szt c=0, i=0; i<len[w2-1]; c++, i++)
@@ -283,7 +283,7 @@ TEST_F(CoreTransformerTest, FuseToLoop)
         }
         for (szt i=0; i<len[w-1]; i++) {
             ASSERT_EQ(m[w].g[i].get_ind(), g[i].get_ind());
-            ASSERT_EQ(m[w].g[i].get_cl(), m[w].get_cl());
+            ASSERT_EQ(ct.edge_cl(w, i), m[w].get_cl());
         }
 
         ASSERT_EQ(m[w].nn[1], 1);
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "../edge_chain.h"
+
+namespace edge_chain_test {
+
+using szt = mitosim::szt;
+using Chain = mitosim::EdgeChain<int>;
+
+Chain make( const int b, const int e )
+{
+    Chain c;
+    for (int i=b; i<e; i++)
+        c.push_back(i);
+    return c;
+}
+
+std::vector<int> items( const Chain& c )
+{
+    return {c.begin(), c.end()};
+}
+
+std::vector<int> range( const int b, const int e )
+{
+    std::vector<int> v(static_cast<szt>(e - b));
+    std::iota(v.begin(), v.end(), b);
+    return v;
+}
+
+TEST(EdgeChainTest, PushBack)
+{
+    auto c = make(0, 5);
+    EXPECT_EQ(c.size(), 5);
+    EXPECT_EQ(c.num_spans(), 1);
+    EXPECT_EQ(c.front(), 0);
+    EXPECT_EQ(c.back(), 4);
+    for (szt i=0; i<c.size(); i++)
+        EXPECT_EQ(c[i], static_cast<int>(i));
+    EXPECT_EQ(items(c), range(0, 5));
+}
+
+TEST(EdgeChainTest, SplitAppend)
+{
+    auto c = make(0, 10);
+    auto t = c.split_off(4);
+    EXPECT_EQ(items(c), range(0, 4));
+    EXPECT_EQ(items(t), range(4, 10));
+
+    // The head shares the block with the tail: being short, it is copied
+    // into a block of its own to grow.
+    c.push_back(20);
+    EXPECT_EQ(c.num_spans(), 1);
+    EXPECT_EQ(c.back(), 20);
+    EXPECT_EQ(t.front(), 4);
+
+    auto u = t.split_off(3);
+    c.append(std::move(u));
+    EXPECT_TRUE(u.empty());
+    EXPECT_EQ(c.num_spans(), 1);
+
+    std::vector<int> e {0, 1, 2, 3, 20, 7, 8, 9};
+    EXPECT_EQ(items(c), e);
+    for (szt i=0; i<e.size(); i++)
+        EXPECT_EQ(c[i], e[i]);
+
+    // Split at a span border and in the middle of a span.
+    auto v = c.split_off(5);
+    EXPECT_EQ(items(v), std::vector<int>({7, 8, 9}));
+    v = c.split_off(2);
+    EXPECT_EQ(items(v), std::vector<int>({2, 3, 20}));
+    EXPECT_EQ(items(c), std::vector<int>({0, 1}));
+    EXPECT_TRUE(c.split_off(2).empty());
+}
+
+TEST(EdgeChainTest, Iterators)
+{
+    auto c = make(0, 3);
+    c.append(make(3, 5));
+    c.append(make(5, 9));
+
+    auto it = c.begin() + 6;
+    EXPECT_EQ(*it, 6);
+    EXPECT_EQ(*--it, 5);
+    EXPECT_EQ(*--it, 4);
+    EXPECT_EQ(*--it, 3);
+    EXPECT_EQ(*--it, 2);
+    EXPECT_EQ(c.end() - c.begin(), 9);
+    EXPECT_EQ(c.begin()[7], 7);
+
+    for (auto& o : c) o *= 2;
+    EXPECT_EQ(c[8], 16);
+
+    std::vector<int> r(c.rbegin(), c.rend());
+    EXPECT_EQ(r.front(), 16);
+    EXPECT_EQ(r.back(), 0);
+}
+
+TEST(EdgeChainTest, Reverse)
+{
+    auto c = make(0, 4);
+    c.append(make(4, 7));
+    auto t = c.split_off(2);
+    t.reverse();
+    EXPECT_EQ(items(t), std::vector<int>({6, 5, 4, 3, 2}));
+    EXPECT_EQ(items(c), std::vector<int>({0, 1}));
+    c.append(std::move(t));
+    EXPECT_EQ(items(c), std::vector<int>({0, 1, 6, 5, 4, 3, 2}));
+}
+
+TEST(EdgeChainTest, Spans)
+{
+    constexpr auto n = static_cast<int>(Chain::blockSize);
+
+    // Blocks are filled before new ones are started.
+    auto c = make(0, 3*n + 8);
+    EXPECT_EQ(c.num_spans(), 4);
+
+    // Undoing a split restores the span without copying.
+    auto t = c.split_off(n + 10);
+    EXPECT_EQ(c.num_spans(), 2);
+    const auto* p = &t[0];
+    c.append(std::move(t));
+    EXPECT_EQ(c.num_spans(), 4);
+    EXPECT_EQ(&c[n + 10], p);
+    EXPECT_EQ(items(c), range(0, 3*n + 8));
+
+    // Long spans are joined as they are.
+    auto d = make(0, n);
+    d.append(make(n, 2*n));
+    EXPECT_EQ(d.num_spans(), 2);
+
+    // Copies are deep.
+    auto e = d;
+    e[0] = -1;
+    EXPECT_EQ(d[0], 0);
+}
+
+TEST(EdgeChainTest, Fragmentation)
+{
+    // Random cuts and joins keep the spans as few as the bound.
+    std::mt19937 rng {1};
+    std::vector<Chain> c;
+    std::vector<std::vector<int>> v;
+    for (int i=0; i<8; i++) {
+        c.push_back(make(100*i, 100*i + 100));
+        v.push_back(range(100*i, 100*i + 100));
+    }
+    const auto pick = [&rng](const szt n) {
+        return std::uniform_int_distribution<szt> {0, n - 1}(rng);
+    };
+    for (int it=0; it<2000; it++) {
+        const auto i = pick(c.size());
+        const auto j = pick(c.size());
+        if (i == j || v[i].empty()) continue;
+        const auto a = pick(v[i].size());
+        auto t = c[i].split_off(a);
+        const auto b = v[i].begin() + static_cast<long>(a);
+        v[j].insert(v[j].end(), b, v[i].end());
+        v[i].erase(b, v[i].end());
+        c[j].append(std::move(t));
+        if (it % 3 == 0) {
+            c[j].reverse();
+            std::reverse(v[j].begin(), v[j].end());
+        }
+    }
+    for (szt i=0; i<c.size(); i++) {
+        ASSERT_EQ(items(c[i]), v[i]);
+        EXPECT_LE(c[i].num_spans(), 4 * c[i].size() / Chain::blockSize + 1);
+    }
+}
+
+// Element counting its live instances.
+struct Counted {
+    static inline int live {};
+    Counted() noexcept { live++; }
+    Counted(const Counted&) noexcept { live++; }
+    Counted& operator=(const Counted&) noexcept = default;
+    ~Counted() { live--; }
+};
+
+TEST(EdgeChainTest, Release)
+{
+    // Blocks no span refers to are released.
+    using C = mitosim::EdgeChain<Counted>;
+    constexpr int n = static_cast<int>(C::blockSize);
+    {
+        C c;
+        for (int i=0; i<10*n; i++)
+            c.push_back({});
+        EXPECT_LE(Counted::live, 10*n + 1);
+
+        auto t = c.split_off(10*n - 5);
+        c.clear();
+        EXPECT_LE(Counted::live, n);
+        EXPECT_EQ(t.size(), 5);
+    }
+    EXPECT_EQ(Counted::live, 0);
+}
+
+}  // namespace edge_chain_test
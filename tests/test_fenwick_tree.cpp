@@ -0,0 +1,60 @@
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "../fenwick_tree.h"
+
+namespace fenwick_tree_test {
+
+using szt = mitosim::szt;
+
+TEST(FenwickTreeTest, Prefix)
+{
+    const std::vector<float> w {3., 0., 1., 4., 0., 2., 5.};
+    mitosim::FenwickTree<float> t;
+    t.reset(w.size());
+    for (szt i=0; i<w.size(); i++)
+        t.set(i, w[i]);
+
+    float s {};
+    for (szt i=0; i<w.size(); i++) {
+        EXPECT_EQ(t.prefix(i), s);
+        EXPECT_EQ(t.get(i), w[i]);
+        s += w[i];
+    }
+    EXPECT_EQ(t.total(), 15.);
+
+    t.set(3, 1.);
+    EXPECT_EQ(t.total(), 12.);
+    EXPECT_EQ(t.prefix(5), 5.);
+}
+
+TEST(FenwickTreeTest, Find)
+{
+    const std::vector<float> w {3., 0., 1., 4., 0., 2., 5.};
+    mitosim::FenwickTree<float> t;
+    t.reset(w.size());
+    for (szt i=0; i<w.size(); i++)
+        t.set(i, w[i]);
+
+    // Each unit interval of the cumulative weight maps to its element.
+    szt i {};
+    float s {};
+    for (float k=0.5; k<t.total(); k+=1.) {
+        while (s + w[i] <= k)
+            s += w[i++];
+        float rest {};
+        EXPECT_EQ(t.find(k, rest), i);
+        EXPECT_FLOAT_EQ(rest, k - s);
+    }
+
+    // Zero weight elements are never found.
+    float rest {};
+    EXPECT_EQ(t.find(3., rest), 2);
+    EXPECT_EQ(t.find(t.total(), rest), 6);
+
+    t.set(6, 0.);
+    EXPECT_EQ(t.find(t.total(), rest), 5);
+}
+
+}  // namespace fenwick_tree_test
@@ -0,0 +1,43 @@
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "../indexed_priority_queue.h"
+
+namespace indexed_priority_queue_test {
+
+using szt = mitosim::szt;
+
+TEST(IndexedPriorityQueueTest, Top)
+{
+    const std::vector<double> k {3., 0.5, 1., 4., 7., 2., 5.};
+    mitosim::IndexedPriorityQueue<double> q;
+    q.reset(k);
+
+    EXPECT_EQ(q.size(), k.size());
+    EXPECT_EQ(q.top(), 1);
+    for (szt i=0; i<k.size(); i++)
+        EXPECT_EQ(q.get(i), k[i]);
+}
+
+TEST(IndexedPriorityQueueTest, Set)
+{
+    std::vector<double> k {3., 0.5, 1., 4., 7., 2., 5.};
+    mitosim::IndexedPriorityQueue<double> q;
+    q.reset(k);
+
+    // Keys changed in both directions keep the smallest one on top.
+    const std::vector<std::pair<szt,double>> changes {
+        {1, 6.}, {4, 0.1}, {4, 8.}, {6, 1.5}, {2, 9.}, {0, 0.}
+    };
+    for (const auto& [i, v] : changes) {
+        q.set(i, v);
+        k[i] = v;
+        const auto min = std::min_element(k.begin(), k.end()) - k.begin();
+        EXPECT_EQ(q.top(), static_cast<szt>(min));
+        EXPECT_EQ(q.get(i), v);
+    }
+}
+
+}  // namespace indexed_priority_queue_test
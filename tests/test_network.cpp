@@ -1,13 +1,27 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <filesystem>
+#include <fstream>
 #include <memory>
+#include <memory_resource>
+#include <ostream>
 #include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 
 #include "../config.h"
 #include "../definitions.h"
+#include "../coarse_segment.h"
 #include "../segment.h"
 #include "../network.h"
+#include "../reactions/fission.h"
+#include "../reactions/fusion11.h"
+#include "../reactions/fusion12.h"
+#include "../reactions/fusion1u.h"
+#include "../simulation.h"
+#include "../tau_leaping.h"
 
 namespace network_test {
 
@@ -35,8 +49,149 @@ protected:
     mitosim::Msgr msgr;
     mitosim::Config<real> conf;
     std::unique_ptr<mitosim::RandFactory> rnd;
+
+    /**
+     * @brief Runs a network over a number of reaction events.
+     * @tparam Ind Index type of the network tables.
+     * @tparam SegmentT Type of the segments.
+     * @param events Number of the events.
+     * @param edges Record the edge indexes, if the segments store them.
+     * @return Simulated time followed by a flat record of the final state.
+     */
+    template<typename Ind, typename SegmentT=Mt>
+    std::pair<double, std::vector<szt>> trajectory(const szt events, const bool edges=true)
+    {
+        using Ntw = mitosim::Network<SegmentT, Ind>;
+
+        mitosim::RandFactory rf {10, msgr};
+        Ntw ntw {conf, rf, msgr};
+        ntw.assemble();
+
+        utils::stochastic::Gillespie<
+            mitosim::RandFactory,
+            utils::stochastic::Reaction<mitosim::RandFactory>> gsp {rf};
+        szt ind {};
+        gsp.add_reaction(std::make_unique<mitosim::Fission<Ntw>>(
+            msgr, ind++, ntw, conf.rate_fission));
+        gsp.add_reaction(std::make_unique<mitosim::Fusion11<Ntw>>(
+            msgr, ind++, ntw, conf.fusion_rate_11));
+        gsp.add_reaction(std::make_unique<mitosim::Fusion12<Ntw>>(
+            msgr, ind++, ntw, conf.fusion_rate_12));
+        gsp.add_reaction(std::make_unique<mitosim::Fusion1U<Ntw>>(
+            msgr, ind++, ntw, conf.fusion_rate_1L));
+        gsp.initialize();
+
+        ntw.update_node_numbers();
+
+        double time {};
+        for (szt i=0; i<events && gsp.set_asum(); i++)
+            gsp.fire(time);
+
+        std::vector<szt> state {ntw.mtnum, ntw.clnum};
+        for (szt w=1; w<=ntw.mtnum; w++) {
+            const auto& m = ntw.mt[w];
+            state.insert(state.end(), {m.get_cl(), m.length()});
+            if constexpr (!SegmentT::coarse)
+                for (szt a=0; edges && a<m.g.size(); a++)
+                    state.push_back(m.edge(a).get_ind());
+            for (szt e=1; e<=2; e++) {
+                state.push_back(m.nn[e]);
+                for (szt k=1; k<=m.nn[e]; k++)
+                    state.insert(state.end(), {m.neig[e][k], m.neen[e][k]});
+            }
+        }
+        state.insert(state.end(), ntw.mt11.begin(), ntw.mt11.end());
+        for (const auto& we : ntw.mt13)
+            state.insert(state.end(), we.begin(), we.end());
+
+        return {time, state};
+    }
+
+    /**
+     * @brief Compares trajectories of the coarse and the edge-storing segments.
+     * @details Being a template, it is instantiated for homogeneous fission
+     * only, which the coarse segments require.
+     * @tparam Coarse Type of the coarse segments.
+     */
+    template<typename Coarse>
+    void compare_coarse()
+    {
+        constexpr szt events {3000};
+
+        const auto fine = trajectory<szt>(events, false);
+        const auto coarse = trajectory<szt, Coarse>(events);
+
+        EXPECT_EQ(fine.first, coarse.first);
+        EXPECT_EQ(fine.second, coarse.second);
+        EXPECT_GT(fine.first, 0.);
+    }
+};
+
+/**
+ * @brief Tau-leaping engine checking the network after each of the leaps.
+ * @details Compares the cluster vectors and the propensities refreshed at the
+ * end of a leap with those computed anew. The loose tolerance makes the leaps
+ * long enough for some of the events to be postponed.
+ * @tparam Ntw Type of the network.
+ */
+template<typename Ntw>
+class CheckedLeaping
+    : public mitosim::TauLeaping<
+        mitosim::RandFactory,
+        utils::stochastic::Reaction<mitosim::RandFactory>> {
+
+    using Base = mitosim::TauLeaping<
+        mitosim::RandFactory,
+        utils::stochastic::Reaction<mitosim::RandFactory>>;
+    using szt = mitosim::szt;
+
+public:
+
+    static inline Ntw* netw {};             ///< The network checked.
+    static inline szt checked {};           ///< Number of the leaps checked.
+    static inline unsigned long postponed {};  ///< Events postponed.
+
+    explicit CheckedLeaping(mitosim::RandFactory& rnd)
+        : Base {rnd, 1.}
+    {}
+
+    /// Fires the reactions, checking the network if it was a leap.
+    void fire(double& time)
+    {
+        const auto leaps = get_leaps();
+        Base::fire(time);
+        postponed = get_postponed();
+        if (get_leaps() > leaps && !testing::Test::HasFailure())
+            check();
+    }
+
+private:
+
+    void check()
+    {
+        checked++;
+
+        const std::array<szt,4> num {netw->mt11.size(), netw->mt13.size(),
+                                     netw->mt22.size(), netw->mt33.size()};
+        netw->populate_cluster_vectors();
+        ASSERT_EQ(num, (std::array<szt,4> {
+            netw->mt11.size(), netw->mt13.size(),
+            netw->mt22.size(), netw->mt33.size()}));
+
+        const auto fis = netw->fis.get_prTotal();
+        const auto pr = netw->fis.get_pr();
+        const auto fu11 = netw->fu11.update_prop({});
+        const auto fu12 = netw->fu12.update_prop({});
+        const auto fu1L = netw->fu1L.update_prop({});
+        ASSERT_EQ(fis, netw->fis.set_prop());
+        ASSERT_EQ(pr, netw->fis.get_pr());
+        ASSERT_EQ(fu11, netw->fu11.set_prop());
+        ASSERT_EQ(fu12, netw->fu12.set_prop());
+        ASSERT_EQ(fu1L, netw->fu1L.set_prop());
+    }
 };
 
+
 TEST_F(NetworkTest, Constructor)
 {
     Network ntw {conf, *rnd, msgr};
@@ -60,4 +215,99 @@ TEST_F(NetworkTest, Constructor)
     ASSERT_TRUE(ntw.mtc13.empty());
 }
 
+TEST_F(NetworkTest, MemoryResource)
+{
+    // Tests that the fusion candidate buffers are drawn from the resource
+    // given to the network.
+    if constexpr (mitosim::implicit_fusion_candidates)
+        GTEST_SKIP() << "Implicit fusion candidates are not buffered";
+
+    struct Counting : std::pmr::memory_resource {
+        szt num {};
+        void* do_allocate(std::size_t n, std::size_t a) override {
+            num++;
+            return std::pmr::new_delete_resource()->allocate(n, a);
+        }
+        void do_deallocate(void* p, std::size_t n, std::size_t a) override {
+            std::pmr::new_delete_resource()->deallocate(p, n, a);
+        }
+        bool do_is_equal(const memory_resource& o) const noexcept override {
+            return this == &o;
+        }
+    } res;
+
+    Network ntw {conf, *rnd, msgr, &res};
+    ntw.assemble();
+    EXPECT_EQ(res.num, 0);
+
+    ntw.fu11.set_prop();
+    ntw.fu12.set_prop();
+    ntw.fu1L.set_prop();
+    EXPECT_GT(res.num, 0);
+}
+
+TEST_F(NetworkTest, IndexWidth)
+{
+    // Tests that the narrow index type reproduces the trajectory
+    // of the wide one event by event.
+    constexpr szt events {3000};
+
+    const auto wide = trajectory<szt>(events);
+    const auto narrow = trajectory<std::uint32_t>(events);
+
+    EXPECT_EQ(wide.first, narrow.first);
+    EXPECT_EQ(wide.second, narrow.second);
+    EXPECT_GT(wide.first, 0.);
+}
+
+TEST_F(NetworkTest, CoarseSegments)
+{
+    // Tests that the segments reduced to their lengths reproduce
+    // the topology trajectory of the segments storing the edges.
+    if constexpr (mitosim::heterogeneous_fission)
+        GTEST_SKIP() << "Coarse segments require homogeneous fission";
+    else
+        compare_coarse<mitosim::CoarseSegment<3>>();
+}
+
+TEST_F(NetworkTest, BatchedLeaps)
+{
+    // Tests that, run by Simulation, the structure and the propensities
+    // refreshed at the end of the batched leaps equal those computed anew.
+    using Sim = mitosim::Simulation<Network, CheckedLeaping<Network>>;
+
+    // The sample configuration, with the periodic output turned off.
+    const auto dir = std::filesystem::temp_directory_path()
+                   / "mitosim_network_test";
+    std::filesystem::create_directories(dir);
+    {
+        std::ifstream ifs {workingDir + "config_" + fnameSuffix + ".txt"};
+        std::ofstream ofs {dir / "config_leaps.txt"};
+        for (std::string line; std::getline(ifs, line); ) {
+            if (line.starts_with("logFrequency") ||
+                line.starts_with("saveFrequency"))
+                line = line.substr(0, line.find('=')) + "= 1000000000";
+            ofs << line << "\n";
+        }
+    }
+    std::ostream sink {nullptr};
+    mitosim::Msgr quiet {&sink, &sink, 6};
+    const mitosim::Config<real> cfg {dir, "leaps", runName, quiet};
+
+    mitosim::RandFactory rf {10, quiet};
+    Network ntw {cfg, rf, quiet};
+    ntw.assemble();
+
+    CheckedLeaping<Network>::netw = &ntw;
+    CheckedLeaping<Network>::checked = 0;
+    CheckedLeaping<Network>::postponed = 0;
+    Sim {ntw, rf, ntw.time, ntw.it, quiet}.initialize()();
+    CheckedLeaping<Network>::netw = nullptr;
+
+    EXPECT_GT(CheckedLeaping<Network>::checked, 50);
+    EXPECT_GT(CheckedLeaping<Network>::postponed, 0);
+
+    std::filesystem::remove_all(dir);
+}
+
 }  // namespace network_test
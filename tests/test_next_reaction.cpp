@@ -0,0 +1,214 @@
+#include <array>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "utils/stochastic/reaction.h"
+
+#include "../definitions.h"
+#include "../next_reaction.h"
+
+namespace next_reaction_test {
+
+using szt = mitosim::szt;
+using RandFactory = mitosim::RandFactory;
+using Reaction = utils::stochastic::Reaction<RandFactory>;
+using Engine = mitosim::NextReaction<RandFactory, Reaction>;
+using Reactions = mitosim::vup<Reaction>;
+
+// Reaction of a fixed score that may switch another one on and itself off.
+class Channel
+    : public Reaction {
+
+public:
+
+    Channel(mitosim::Msgr& msgr, szt ind, double rate, Channel* next=nullptr)
+        : Reaction {msgr, ind, rate, "ch" + std::to_string(ind), "channel"}
+        , next {next}
+    {}
+
+    double a {};          // Current propensity.
+    Channel* next {};     // Switched on when this one fires.
+
+    void set_score() noexcept override { *score = rate * a; }
+    void update_prop(szt, szt) noexcept override {}
+    void set_prop() noexcept override {}
+    void update_netw_stats() override {}
+    void initialize_dependencies(const Reactions&) noexcept override
+    {
+        if (next) dependents.push_back(next);
+        set_score();
+    }
+    void fire() noexcept override
+    {
+        eventCount++;
+        if (!next) return;
+        a = 0.;
+        set_score();
+        next->a = 1.;
+        next->set_score();
+    }
+};
+
+// Reaction of a fixed score that steps the propensity of another one
+// through a cycle of levels.
+class Modulator
+    : public Reaction {
+
+public:
+
+    Modulator(mitosim::Msgr& msgr, szt ind, double rate,
+              Channel& target, std::vector<double> levels)
+        : Reaction {msgr, ind, rate, "md" + std::to_string(ind), "modulator"}
+        , target {target}
+        , levels {std::move(levels)}
+    {}
+
+    Channel& target;              // Its propensity is modulated.
+    std::vector<double> levels;   // Propensities cycled through.
+    szt k {};                     // Current level.
+
+    void set_score() noexcept override { *score = rate; }
+    void update_prop(szt, szt) noexcept override {}
+    void set_prop() noexcept override {}
+    void update_netw_stats() override {}
+    void initialize_dependencies(const Reactions&) noexcept override
+    {
+        dependents.push_back(&target);
+        set_score();
+    }
+    void fire() noexcept override
+    {
+        eventCount++;
+        k = (k + 1) % levels.size();
+        target.a = levels[k];
+        target.set_score();
+    }
+};
+
+class NextReactionTest
+    : public testing::Test {
+
+protected:
+
+    mitosim::Msgr msgr;
+    RandFactory rnd {7, msgr};
+};
+
+TEST_F(NextReactionTest, Frequencies)
+{
+    // Independent channels fire in proportion to their scores,
+    // at the waiting times of the total score.
+    constexpr szt events {40000};
+    const std::array<double,3> rates {1., 3., 0.};
+
+    Engine e {rnd};
+    std::array<Channel*,3> ch {};
+    for (szt i=0; i<rates.size(); i++) {
+        auto r = std::make_unique<Channel>(msgr, i, rates[i]);
+        r->a = 1.;
+        ch[i] = r.get();
+        e.add_reaction(std::move(r));
+    }
+    e.initialize();
+
+    double time {};
+    for (szt i=0; i<events; i++) {
+        ASSERT_TRUE(e.set_asum());
+        e.fire(time);
+        ASSERT_GE(e.tau(), 0.);
+    }
+
+    EXPECT_EQ(ch[2]->eventCount, 0);
+    EXPECT_NEAR(static_cast<double>(ch[1]->eventCount) / events, 0.75, 0.01);
+    EXPECT_NEAR(time / events, 0.25, 0.01);
+}
+
+TEST_F(NextReactionTest, Dependents)
+{
+    // A channel switched off is never chosen, and one switched on
+    // by a dependency starts firing.
+    Engine e {rnd};
+    auto r1 = std::make_unique<Channel>(msgr, 1, 2.);
+    auto r0 = std::make_unique<Channel>(msgr, 0, 1., r1.get());
+    r0->a = 1.;
+    const auto c0 = r0.get();
+    const auto c1 = r1.get();
+    e.add_reaction(std::move(r0));
+    e.add_reaction(std::move(r1));
+    e.initialize();
+
+    double time {};
+    ASSERT_TRUE(e.set_asum());
+    e.fire(time);
+    EXPECT_EQ(c0->eventCount, 1);
+    EXPECT_EQ(c1->eventCount, 0);
+
+    for (szt i=0; i<100; i++)
+        e.fire(time);
+    EXPECT_EQ(c0->eventCount, 1);
+    EXPECT_EQ(c1->eventCount, 100);
+
+    // Nothing is left to fire if every score is zero.
+    Engine idle {rnd};
+    auto r = std::make_unique<Channel>(msgr, 0, 1.);
+    idle.add_reaction(std::move(r));
+    idle.initialize();
+    EXPECT_FALSE(idle.set_asum());
+}
+
+TEST_F(NextReactionTest, RescaledWaitingTimes)
+{
+    // A channel whose score is changed by another one while it waits
+    // keeps its waiting time, rescaled: the score integrated over each of
+    // its waiting times is distributed exponentially with mean 1.
+    // The changes include switching the channel off and on again.
+    constexpr szt events {100000};
+    constexpr szt n {10};
+
+    Engine e {rnd};
+    auto r1 = std::make_unique<Channel>(msgr, 1, 1.);
+    r1->a = 0.5;
+    const auto c = r1.get();
+    auto r0 = std::make_unique<Modulator>(msgr, 0, 5., *c,
+                                          std::vector {0.5, 2., 0., 3.});
+    e.add_reaction(std::move(r0));
+    e.add_reaction(std::move(r1));
+    e.initialize();
+
+    // Quantiles of the exponential distribution bounding the bins.
+    std::array<double,n> upper {};
+    for (szt b=0; b<n; b++)
+        upper[b] = -std::log(1. - static_cast<double>(b + 1) / n);
+
+    std::array<szt,n> freq {};
+    szt samples {};
+    double integral {};
+    double time {};
+    for (szt i=0; i<events; i++) {
+        ASSERT_TRUE(e.set_asum());
+        const auto a = c->rate * c->a;
+        const auto count = c->eventCount;
+        e.fire(time);
+        integral += a * e.tau();
+        if (c->eventCount == count) continue;
+
+        szt b {};
+        while (b < n - 1 && integral > upper[b]) b++;
+        freq[b]++;
+        samples++;
+        integral = 0.;
+    }
+
+    ASSERT_GT(samples, 1000);
+    const auto expected = static_cast<double>(samples) / n;
+    double chi2 {};
+    for (const auto k : freq)
+        chi2 += std::pow(k - expected, 2) / expected;
+    EXPECT_LT(chi2, n - 1 + 5 * std::sqrt(2. * (n - 1)));
+}
+
+}  // namespace next_reaction_test
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "../config.h"
+#include "../definitions.h"
+#include "../segment.h"
+#include "../network.h"
+#include "ntw_fission.h"
+
+namespace ntw_fission_test {
+
+class NtwFissionTest
+    : public testing::Test {
+
+protected:
+
+    using Mt = mitosim::Segment<3>;
+    using Network = mitosim::Network<Mt>;
+    using RandFactory = mitosim::RandFactory;
+    using real = mitosim::real;
+    using szt = mitosim::szt;
+    using NtwFission = mitosim::NtwFission<Network>;
+
+    const std::string workingDir {std::filesystem::current_path()
+                                  / "tests" / "data/"};
+    const std::string fnameSuffix {"sample"};
+    const std::string runName {"42"};
+
+    NtwFissionTest()
+        : msgr {}
+        , conf {workingDir, fnameSuffix, runName, msgr}
+        , rnd {std::make_unique<mitosim::RandFactory>(10, msgr)}
+        , ntw {conf, *rnd, msgr}
+    {}
+
+    mitosim::Msgr msgr;
+    mitosim::Config<real> conf;
+    std::unique_ptr<RandFactory> rnd;
+    Network ntw;
+
+    /**
+     * @brief Fission weight of a node as given by the edge end factors.
+     * @details Every edge end facing a connected node has factor 1, and
+     * the node sums the factors of the edge ends it joins (see
+     * Segment::set_fins()).
+     * @param m The segment.
+     * @param a In-segment position of the node.
+     */
+    static real node_weight(const Mt& m, const szt a)
+    {
+        const auto fin = [&m](const szt b, const szt i) {
+            return i == 0 ? (b > 0 || m.nn[1] ? 1 : 0)
+                          : (b + 1 < m.length() || m.nn[2] ? 1 : 0);
+        };
+        return static_cast<real>((a ? fin(a-1, 1) : 0) +
+                                 (a < m.length() ? fin(a, 0) : 0));
+    }
+
+    /// Produces 11-, 13-, 33- and 22-segments, including ones of length 1.
+    void make_network()
+    {
+        constexpr std::array<szt,7> len {4, 1, 7, 2, 5, 3, 6};
+
+        for (const auto u : len)
+            ntw.add_disconnected_segment(u);
+        ntw.fuse12(1, 1, 3, 2);          // produces 13-segments
+        ntw.fuse11(5, 1, 5, 2);          // produces a 22-segment
+        ntw.fuse12(2, 2, 1, 2);          // produces 33-segments
+        ntw.make_indma();
+        ntw.populate_cluster_vectors();
+    }
+};
+
+TEST_F(NtwFissionTest, SetProp)
+{
+    // Tests that the segment weights sum to the edge end factors.
+    make_network();
+
+    real total {};
+    for (szt w=1; w<=ntw.mtnum; w++)
+        for (szt a=0; a<=ntw.mt[w].length(); a++)
+            total += node_weight(ntw.mt[w], a);
+
+    NtwFission nf {ntw};
+    EXPECT_EQ(nf.set_prop(), total);
+    EXPECT_EQ(nf.get_prTotal(), total);
+}
+
+TEST_F(NtwFissionTest, Draw)
+{
+    // Tests that the sites are drawn in proportion to the edge end factors:
+    // bulk nodes, connected ends, the junction of a cycle (at both of its
+    // ends) and never the free ends.
+    make_network();
+
+    NtwFission nf {ntw};
+    const auto total = nf.set_prop();
+
+    std::map<std::array<szt,2>, real> weight;
+    std::map<std::array<szt,2>, szt> freq;
+    for (szt w=1; w<=ntw.mtnum; w++)
+        for (szt a=0; a<=ntw.mt[w].length(); a++)
+            if (const auto f = node_weight(ntw.mt[w], a); f > 0) {
+                weight[{w, a}] = f;
+                freq[{w, a}] = 0;
+            }
+
+    const szt draws {400 * freq.size()};
+    for (szt i=0; i<draws; i++) {
+        const auto s = nf.draw();
+        const auto f = freq.find(s);
+        ASSERT_NE(f, freq.end()) << s[0] << " " << s[1];
+        f->second++;
+    }
+
+    // Pearson statistic, bounded by its mean n-1 plus 5 standard deviations.
+    const auto n = freq.size();
+    double chi2 {};
+    for (const auto& [s, k] : freq) {
+        const auto expected = draws * weight[s] / total;
+        chi2 += std::pow(k - expected, 2) / expected;
+    }
+    EXPECT_LT(chi2, n - 1 + 5 * std::sqrt(2. * (n - 1)));
+}
+
+}  // namespace ntw_fission_test
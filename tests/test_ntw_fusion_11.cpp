@@ -1,6 +1,12 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <filesystem>
+#include <map>
 #include <memory>
+#include <memory_resource>
 #include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -23,6 +29,7 @@ protected:
     using real = mitosim::real;
     using szt = mitosim::szt;
     using NtwFusion11 = mitosim::NtwFusion11<Network>;
+    using NtwFusion11Implicit = mitosim::NtwFusion11<Network, true>;
 
     static constexpr auto minLL =
         mitosim::Structure<typename Network::ST>::minLoopLength;
@@ -67,5 +74,174 @@ TEST_F(NtwFusion11Test, SetProp)
 
     EXPECT_EQ(nf.get_cnd().size(), 7*6/2);
 }
+TEST_F(NtwFusion11Test, SetPropImplicit)
+{
+    // Tests that counting reproduces the size of the explicit candidate list.
+    constexpr std::array<szt,6> len {4, 1, 9, 5, 1, 6};
+
+    for (const auto u : len)
+        ntw.add_disconnected_segment(u);
+
+    NtwFusion11 nf {ntw};
+    NtwFusion11Implicit nfi {ntw};
+
+    ntw.populate_cluster_vectors();
+    EXPECT_EQ(nfi.set_prop(), nf.set_prop());
+
+    ntw.fuse12(1, 1, 3, 3);
+    ntw.fuse12(4, 2, 1, 2);
+    ntw.populate_cluster_vectors();
+    EXPECT_EQ(nfi.set_prop(), nf.set_prop());
+
+    EXPECT_TRUE(nfi.get_cnd().size() == 0);
+}
+
+TEST_F(NtwFusion11Test, UpdateProp)
+{
+    // Tests that renewing the pairs of the touched segments reproduces
+    // the candidates populated anew after a series of transformations.
+    constexpr std::array<szt,7> len {4, 1, 7, 2, 5, 3, 6};
+
+    for (const auto u : len)
+        ntw.add_disconnected_segment(u);
+    ntw.populate_cluster_vectors();
+
+    NtwFusion11 nf {ntw};
+    nf.set_prop();
+    NtwFusion11Implicit nfi {ntw};
+    nfi.set_prop();
+    ntw.touched.clear();
+
+    const auto sorted = [](const auto& cnd) {
+        std::vector<std::array<std::array<mitosim::Index,2>,2>> p;
+        for (szt i=0; i<cnd.size(); i++)
+            p.push_back({std::min(cnd[i].u, cnd[i].v),
+                         std::max(cnd[i].u, cnd[i].v)});
+        std::sort(p.begin(), p.end());
+        return p;
+    };
+
+    for (szt i=0; i<24; i++) {
+        NtwFusion11 full {ntw};
+        full.set_prop();
+        const auto& c = full.get_cnd();
+
+        if (i % 2 == 0 && c.size()) {
+            const auto r = 7 * i % c.size();
+            ntw.fuse11(c[r].u[0], c[r].u[1], c[r].v[0], c[r].v[1]);
+        }
+        else {
+            const auto w = 1 + i % ntw.mtnum;
+            const auto a = ntw.mt[w].g.size() / 2;
+            if (a)
+                ntw.fiss(w, a);
+        }
+        ntw.make_indma();
+        ntw.populate_cluster_vectors();
+
+        nf.update_prop(ntw.touched);
+        const auto ni = nfi.update_prop(ntw.touched);
+        ntw.touched.clear();
+
+        NtwFusion11 fresh {ntw};
+        EXPECT_EQ(nf.get_cnd().size(), fresh.set_prop());
+        EXPECT_EQ(sorted(nf.get_cnd()), sorted(fresh.get_cnd()));
+        EXPECT_EQ(ni, fresh.get_cnd().size());
+    }
+}
+
+TEST_F(NtwFusion11Test, DrawImplicit)
+{
+    // Tests that unranking picks every pair of the explicit candidate
+    // list with equal frequency, and nothing else.
+    constexpr std::array<szt,8> len {4, 1, 9, 5, 1, 6, 3, 2};
+
+    for (const auto u : len)
+        ntw.add_disconnected_segment(u);
+    ntw.fuse12(1, 1, 3, 3);
+    ntw.fuse12(4, 2, 1, 2);
+    ntw.populate_cluster_vectors();
+
+    NtwFusion11 nf {ntw};
+    NtwFusion11Implicit nfi {ntw};
+    const auto n = nf.set_prop();
+    ASSERT_EQ(nfi.set_prop(), n);
+
+    using Pair = std::array<std::array<szt,2>,2>;
+    const auto pair = [](const std::array<szt,2> u,
+                         const std::array<szt,2> v) {
+        return Pair {std::min(u, v), std::max(u, v)};
+    };
+
+    std::map<Pair, szt> freq;
+    const auto& c = nf.get_cnd();
+    for (szt i=0; i<n; i++)
+        freq[pair({c[i].u[0], c[i].u[1]}, {c[i].v[0], c[i].v[1]})] = 0;
+    ASSERT_EQ(freq.size(), n);
+
+    const szt draws {400 * n};
+    for (szt i=0; i<draws; i++) {
+        const auto p = nfi.draw();
+        const auto f = freq.find(pair({p[0], p[1]}, {p[2], p[3]}));
+        ASSERT_NE(f, freq.end()) << p[0] << " " << p[1] << " "
+                                 << p[2] << " " << p[3];
+        f->second++;
+    }
+
+    // Pearson statistic against the uniform distribution, bounded
+    // by its mean n-1 plus 5 standard deviations.
+    const auto expected = static_cast<double>(draws) / n;
+    double chi2 {};
+    for (const auto& [p, k] : freq)
+        chi2 += std::pow(k - expected, 2) / expected;
+    EXPECT_LT(chi2, n - 1 + 5 * std::sqrt(2. * (n - 1)));
+}
+
+TEST_F(NtwFusion11Test, PooledBuffers)
+{
+    // Tests that the candidate buffers are drawn from the resource given
+    // and retain their capacity when populated anew.
+    struct Counting : std::pmr::memory_resource {
+        szt num {};
+        void* do_allocate(std::size_t n, std::size_t a) override {
+            num++;
+            return std::pmr::new_delete_resource()->allocate(n, a);
+        }
+        void do_deallocate(void* p, std::size_t n, std::size_t a) override {
+            std::pmr::new_delete_resource()->deallocate(p, n, a);
+        }
+        bool do_is_equal(const memory_resource& o) const noexcept override {
+            return this == &o;
+        }
+    } res;
+
+    constexpr std::array<szt,6> len {4, 1, 9, 5, 1, 6};
+    for (const auto u : len)
+        ntw.add_disconnected_segment(u);
+    ntw.populate_cluster_vectors();
+
+    NtwFusion11 nf {ntw, &res};
+    const auto n = nf.set_prop();
+    EXPECT_GT(n, 0);
+    EXPECT_GT(res.num, 0);
+
+    const auto num = res.num;
+    EXPECT_EQ(nf.set_prop(), n);
+    EXPECT_EQ(res.num, num);
+}
+
+TEST(FreeEndsTest, UnrankPair)
+{
+    using szt = mitosim::szt;
+
+    constexpr szt n {60};
+    szt r {};
+    for (szt j=1; j<n; j++)
+        for (szt i=0; i<j; i++) {
+            const auto p = mitosim::FreeEnds<>::unrank_pair(r++);
+            ASSERT_EQ(p[0], i);
+            ASSERT_EQ(p[1], j);
+        }
+}
 
 }  // namespace ntw_fusion11_test
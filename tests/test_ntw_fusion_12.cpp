@@ -1,6 +1,11 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <filesystem>
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -23,6 +28,7 @@ protected:
     using real = mitosim::real;
     using szt = mitosim::szt;
     using NtwFusion12 = mitosim::NtwFusion12<Network>;
+    using NtwFusion12Implicit = mitosim::NtwFusion12<Network, true>;
 
     static constexpr auto minLL =
         mitosim::Structure<typename Network::ST>::minLoopLength;
@@ -85,5 +91,132 @@ TEST_F(NtwFusion12Test, SetProp2)
     EXPECT_EQ(nf.get_cnd().size(), 35);
 }
 
+TEST_F(NtwFusion12Test, SetPropImplicit)
+{
+    // Tests that counting reproduces the size of the explicit candidate list.
+    constexpr std::array<szt,5> len {4, 1, 7, 2, 5};
+
+    for (const auto u : len)
+        ntw.add_disconnected_segment(u);
+
+    NtwFusion12 nf {ntw};
+    NtwFusion12Implicit nfi {ntw};
+
+    ntw.populate_cluster_vectors();
+    EXPECT_EQ(nfi.set_prop(), nf.set_prop());
+
+    ntw.fuse12(1, 1, 3, 2);          // produces 13-segments
+    ntw.populate_cluster_vectors();
+    EXPECT_EQ(nfi.set_prop(), nf.set_prop());
+
+    ntw.fuse11(5, 1, 5, 2);          // produces a 22-segment
+    ntw.populate_cluster_vectors();
+    EXPECT_EQ(nfi.set_prop(), nf.set_prop());
+
+    ntw.fuse12(4, 2, 1, 2);          // produces 33-segments
+    ntw.populate_cluster_vectors();
+    EXPECT_EQ(nfi.set_prop(), nf.set_prop());
+
+    EXPECT_TRUE(nfi.get_cnd().size() == 0);
+}
+
+TEST_F(NtwFusion12Test, UpdateProp)
+{
+    // Tests that renewing the pairs of the touched segments reproduces
+    // the candidates populated anew after a series of transformations.
+    constexpr std::array<szt,7> len {4, 1, 7, 2, 5, 3, 6};
+
+    for (const auto u : len)
+        ntw.add_disconnected_segment(u);
+    ntw.populate_cluster_vectors();
+
+    NtwFusion12 nf {ntw};
+    nf.set_prop();
+    NtwFusion12Implicit nfi {ntw};
+    nfi.set_prop();
+    ntw.touched.clear();
+
+    const auto sorted = [](const auto& cnd) {
+        std::vector<std::array<szt,4>> p;
+        for (szt i=0; i<cnd.size(); i++)
+            p.push_back({cnd[i].u[0], cnd[i].u[1], cnd[i].v[0], cnd[i].v[1]});
+        std::sort(p.begin(), p.end());
+        return p;
+    };
+
+    for (szt i=0; i<30; i++) {
+        NtwFusion12 full {ntw};
+        full.set_prop();
+        const auto& c = full.get_cnd();
+
+        if (i % 3 == 0 && c.size()) {
+            const auto r = 7 * i % c.size();
+            ntw.fuse12(c[r].u[0], c[r].u[1], c[r].v[0], c[r].v[1]);
+        }
+        else if (i % 3 == 1 && ntw.mt11.size()) {
+            const auto w = ntw.mt11[i % ntw.mt11.size()];
+            if (ntw.mt[w].g.size() >= minLL)
+                ntw.fuse11(w, 1, w, 2);
+        }
+        else {
+            const auto w = 1 + i % ntw.mtnum;
+            if (ntw.mt[w].g.size() > 1)
+                ntw.fiss(w, ntw.mt[w].g.size() / 2);
+        }
+        ntw.make_indma();
+        ntw.populate_cluster_vectors();
+
+        nf.update_prop(ntw.touched);
+        const auto ni = nfi.update_prop(ntw.touched);
+        ntw.touched.clear();
+
+        NtwFusion12 fresh {ntw};
+        EXPECT_EQ(nf.get_cnd().size(), fresh.set_prop());
+        EXPECT_EQ(sorted(nf.get_cnd()), sorted(fresh.get_cnd()));
+        EXPECT_EQ(ni, fresh.get_cnd().size());
+    }
+}
+
+TEST_F(NtwFusion12Test, DrawImplicit)
+{
+    // Tests that the two-stage draw picks every pair of the explicit
+    // candidate list with equal frequency, and nothing else.
+    constexpr std::array<szt,7> len {4, 1, 7, 2, 5, 3, 6};
+
+    for (const auto u : len)
+        ntw.add_disconnected_segment(u);
+    ntw.fuse12(1, 1, 3, 2);          // produces 13-segments
+    ntw.fuse11(5, 1, 5, 2);          // produces a 22-segment
+    ntw.fuse12(2, 2, 1, 2);          // produces 33-segments
+    ntw.populate_cluster_vectors();
+
+    NtwFusion12 nf {ntw};
+    NtwFusion12Implicit nfi {ntw};
+    const auto n = nf.set_prop();
+    ASSERT_EQ(nfi.set_prop(), n);
+
+    std::map<std::array<szt,4>, szt> freq;
+    const auto& c = nf.get_cnd();
+    for (szt i=0; i<n; i++)
+        freq[{c[i].u[0], c[i].u[1], c[i].v[0], c[i].v[1]}] = 0;
+    ASSERT_EQ(freq.size(), n);
+
+    const szt draws {400 * n};
+    for (szt i=0; i<draws; i++) {
+        const auto p = nfi.draw();
+        const auto f = freq.find({p[0], p[1], p[2], p[3]});
+        ASSERT_NE(f, freq.end()) << p[0] << " " << p[1] << " "
+                                 << p[2] << " " << p[3];
+        f->second++;
+    }
+
+    // Pearson statistic against the uniform distribution, bounded
+    // by its mean n-1 plus 5 standard deviations.
+    const auto expected = static_cast<double>(draws) / n;
+    double chi2 {};
+    for (const auto& [p, k] : freq)
+        chi2 += std::pow(k - expected, 2) / expected;
+    EXPECT_LT(chi2, n - 1 + 5 * std::sqrt(2. * (n - 1)));
+}
 
 }  // namespace ntw_fusion12_test
@@ -1,6 +1,8 @@
+#include <algorithm>
 #include <filesystem>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -25,6 +27,7 @@ protected:
     using real = mitosim::real;
     using szt = mitosim::szt;
     using NtwFusion1U = mitosim::NtwFusion1U<Network>;
+    using NtwFusion1UImplicit = mitosim::NtwFusion1U<Network, true>;
 
     class Ntw : public Network {
 
@@ -85,5 +88,79 @@ TEST_F(NtwFusion1UTest, SetProp)
     EXPECT_EQ(nf.get_cnd().size(), 8);
 }
 
+TEST_F(NtwFusion1UTest, SetPropImplicit)
+{
+    // Tests that the product form reproduces the explicit candidate list.
+    constexpr std::array<szt,5> len {4, 8, 3, 5, 6};
+
+    for (const auto u : len)
+        ntw.add_disconnected_segment(u);
+    ntw.fuse_to_loop(1);
+    ntw.fuse_to_loop(2);
+    ntw.fuse12(3, 1, 4, 2);
+
+    NtwFusion1U nf {ntw};
+    NtwFusion1UImplicit nfi {ntw};
+    ntw.populate_cluster_vectors();
+
+    EXPECT_EQ(nfi.set_prop(), nf.set_prop());
+    EXPECT_EQ(nfi.set_prop(), (2*1 + 3) * 2);
+    EXPECT_EQ(nfi.get_cnd().size(), 0);
+}
+
+TEST_F(NtwFusion1UTest, UpdateProp)
+{
+    // Tests that renewing the pairs of the touched segments reproduces
+    // the candidates populated anew after a series of transformations.
+    constexpr std::array<szt,7> len {4, 8, 3, 5, 6, 2, 7};
+
+    for (const auto u : len)
+        ntw.add_disconnected_segment(u);
+    ntw.fuse_to_loop(1);
+    ntw.fuse_to_loop(2);
+    ntw.populate_cluster_vectors();
+
+    NtwFusion1U nf {ntw};
+    nf.set_prop();
+    ntw.touched.clear();
+
+    const auto sorted = [](const auto& cnd) {
+        std::vector<std::array<szt,3>> p;
+        for (szt i=0; i<cnd.size(); i++)
+            p.push_back({cnd[i].u[0], cnd[i].u[1], cnd[i].v});
+        std::sort(p.begin(), p.end());
+        return p;
+    };
+
+    for (szt i=0; i<24; i++) {
+        NtwFusion1U full {ntw};
+        full.set_prop();
+        const auto& c = full.get_cnd();
+
+        if (i % 3 == 0 && c.size()) {
+            const auto r = 5 * i % c.size();
+            ntw.fuse1L(c[r].u[0], c[r].u[1], c[r].v);
+        }
+        else if (i % 3 == 1 && ntw.mt11.size()) {
+            const auto w = ntw.mt11[i % ntw.mt11.size()];
+            if (ntw.mt[w].g.size() >= minLL)
+                ntw.fuse_to_loop(w);
+        }
+        else {
+            const auto w = 1 + i % ntw.mtnum;
+            if (ntw.mt[w].g.size() > 1)
+                ntw.fiss(w, ntw.mt[w].g.size() / 2);
+        }
+        ntw.make_indma();
+        ntw.populate_cluster_vectors();
+
+        nf.update_prop(ntw.touched);
+        ntw.touched.clear();
+
+        NtwFusion1U fresh {ntw};
+        EXPECT_EQ(nf.get_cnd().size(), fresh.set_prop());
+        EXPECT_EQ(sorted(nf.get_cnd()), sorted(fresh.get_cnd()));
+    }
+}
 
 }  // namespace ntw_fusion1u_test
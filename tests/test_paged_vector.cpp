@@ -0,0 +1,68 @@
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "../paged_vector.h"
+
+namespace paged_vector_test {
+
+using szt = mitosim::szt;
+
+// Element counting its live instances; not default constructible.
+struct Counted {
+    static inline int live {};
+    szt v;
+    explicit Counted(const szt v) : v {v} { live++; }
+    ~Counted() { live--; }
+};
+
+TEST(PagedVectorTest, StableAddresses)
+{
+    mitosim::PagedVector<Counted,4> p;
+    EXPECT_TRUE(p.empty());
+
+    std::vector<const Counted*> a;
+    for (szt i=0; i<10; i++)
+        a.push_back(&p.emplace_back(i));
+    EXPECT_EQ(p.size(), 10);
+    EXPECT_EQ(p.capacity(), 12);
+    EXPECT_EQ(Counted::live, 10);
+
+    // Growth keeps the elements in place.
+    for (szt i=10; i<100; i++)
+        p.emplace_back(i);
+    for (szt i=0; i<10; i++) {
+        EXPECT_EQ(&p[i], a[i]);
+        EXPECT_EQ(p[i].v, i);
+    }
+    EXPECT_EQ(p.back().v, 99);
+
+    p.pop_back();
+    EXPECT_EQ(p.size(), 99);
+    EXPECT_EQ(Counted::live, 99);
+
+    p.clear();
+    EXPECT_EQ(Counted::live, 0);
+    EXPECT_EQ(p.capacity(), 100);
+}
+
+TEST(PagedVectorTest, Reserve)
+{
+    mitosim::PagedVector<Counted,4> p;
+    p.reserve(9);
+    EXPECT_EQ(p.capacity(), 12);
+    EXPECT_TRUE(p.empty());
+
+    // Pages are retained and reused.
+    const auto& a = p.emplace_back(1);
+    p.pop_back();
+    EXPECT_EQ(&p.emplace_back(2), &a);
+    EXPECT_EQ(p.capacity(), 12);
+
+    mitosim::PagedVector<Counted,4> q {std::move(p)};
+    EXPECT_EQ(q.size(), 1);
+    EXPECT_EQ(q[0].v, 2);
+    EXPECT_TRUE(p.empty());
+}
+
+}  // namespace paged_vector_test
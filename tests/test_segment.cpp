@@ -1,3 +1,6 @@
+#include <filesystem>
+#include <fstream>
+
 #include "gtest/gtest.h"
 
 #include "../definitions.h"
@@ -65,27 +68,61 @@ TEST_F(SegmentTest, Constructor2)
     EXPECT_EQ(sg.nn[1], 0);
     for (szt i = 1; i<sg.g.size(); i++) {
         EXPECT_EQ(sg.g[i-1].get_ind() + 1, sg.g[i].get_ind());
+        if constexpr (mitosim::lazy_edge_cl) continue;
         EXPECT_EQ(sg.g[i-1].get_indcl() + 1, sg.g[i].get_indcl());
         EXPECT_EQ(sg.g[i-1].get_cl(), sg.g[i].get_cl());
     }
-    for (szt i = 1; i<sg.g.size(); i++) {
-        EXPECT_EQ(sg.g[i].get_fin(0), 0.);
-        EXPECT_EQ(sg.g[i].get_fin(1), 0.);
-    }
+    // The stored factors are not set by the constructor.
+    if constexpr (mitosim::heterogeneous_fission)
+        for (szt i = 1; i<sg.g.size(); i++) {
+            EXPECT_EQ(sg.get_fin(i, 0), 0.);
+            EXPECT_EQ(sg.get_fin(i, 1), 0.);
+        }
 }
 
 TEST_F(SegmentTest, reflectG)
 {
     Segment sg {Config::segmass, Config::cl, conf.ei0, msgr};
     sg.reflect_g();
+    ASSERT_TRUE(sg.is_reversed());
+
+    // The edges are seen in the reverse order, but stay in place.
+    for (szt i = 0; i < sg.g.size(); i++) {
+        EXPECT_EQ(sg.edge(i).get_ind(), conf.ei0 + Config::segmass - i - 1);
+        EXPECT_EQ(sg.g[i].get_ind(), conf.ei0 + i);
+    }
+    EXPECT_EQ(sg.g[sg.end2a(1)].get_ind(), conf.ei0 + Config::segmass - 1);
+    EXPECT_EQ(sg.g[sg.end2a(2)].get_ind(), conf.ei0);
+
+    sg.orient();
+    ASSERT_FALSE(sg.is_reversed());
 
     for (szt i = 0; i < sg.g.size(); i++) {
         EXPECT_EQ(sg.g[i].get_ind(), conf.ei0 + Config::segmass - i - 1);
+        if constexpr (mitosim::lazy_edge_cl) continue;
         EXPECT_EQ(sg.g[i].get_indcl(), sg.g.size() - i - 1);
         EXPECT_EQ(sg.g[i].get_cl(), Config::cl);
     }
 }
 
+TEST_F(SegmentTest, splitReflectedG)
+{
+    Segment sg {Config::segmass, Config::cl, conf.ei0, msgr};
+    Segment tail {msgr};
+    const szt a {3};
+    sg.reflect_g();
+    sg.split_g(a, tail);
+
+    ASSERT_EQ(sg.g.size(), a);
+    ASSERT_EQ(tail.g.size(), Config::segmass - a);
+    EXPECT_TRUE(tail.is_reversed());
+    for (szt i = 0; i < sg.g.size(); i++)
+        EXPECT_EQ(sg.edge(i).get_ind(), conf.ei0 + Config::segmass - i - 1);
+    for (szt i = 0; i < tail.g.size(); i++)
+        EXPECT_EQ(tail.edge(i).get_ind(),
+                  conf.ei0 + Config::segmass - a - i - 1);
+}
+
 TEST_F(SegmentTest, setGCl)
 {
     Segment sg {Config::segmass, Config::cl, conf.ei0, msgr};
@@ -95,12 +132,15 @@ TEST_F(SegmentTest, setGCl)
     const auto res = sg.set_gCl(newCl, newIndcl);
 
     for (szt i = 0; i < sg.g.size(); i++) {
-        EXPECT_EQ(sg.g[i].get_indcl(), newIndcl + i);
         EXPECT_EQ(sg.g[i].get_ind(), conf.ei0 + i);
-        EXPECT_EQ(sg.g[i].get_cl(), newCl);
-        EXPECT_EQ(sg.g[i].get_fin(0), 0.);
-        EXPECT_EQ(sg.g[i].get_fin(1), 0.);
+        if constexpr (mitosim::heterogeneous_fission) {
+            EXPECT_EQ(sg.get_fin(i, 0), 0.);
+            EXPECT_EQ(sg.get_fin(i, 1), 0.);
+        }
         EXPECT_EQ(res, newIndcl + sg.g.size());
+        if constexpr (mitosim::lazy_edge_cl) continue;
+        EXPECT_EQ(sg.g[i].get_indcl(), newIndcl + i);
+        EXPECT_EQ(sg.g[i].get_cl(), newCl);
     }
 }
 
@@ -172,43 +212,117 @@ TEST_F(SegmentTest, NumNodes)
 TEST_F(SegmentTest, SetEndFin1)
 {
     Segment sg {Config::segmass, Config::cl, conf.ei0, msgr};
-    sg.template set_end_fin<1>();
+    EXPECT_EQ(sg.template set_end_fin<1>(), 0.);
 
-    for (const auto& g : sg.g) {
-        EXPECT_EQ(g.get_fin(0), 0.);
-        EXPECT_EQ(g.get_fin(1), 0.);
-    }
+    if constexpr (mitosim::heterogeneous_fission)
+        for (szt i = 0; i < sg.g.size(); i++) {
+            EXPECT_EQ(sg.get_fin(i, 0), 0.);
+            EXPECT_EQ(sg.get_fin(i, 1), 0.);
+        }
 }
 
 TEST_F(SegmentTest, SetEndFin2)
 {
     Segment sg {Config::segmass, Config::cl, conf.ei0, msgr};
-    sg.template set_end_fin<2>();
+    EXPECT_EQ(sg.template set_end_fin<2>(), 0.);
 
-    for (const auto& g : sg.g) {
-        EXPECT_EQ(g.get_fin(0), 0.);
-        EXPECT_EQ(g.get_fin(1), 0.);
-    }
+    if constexpr (mitosim::heterogeneous_fission)
+        for (szt i = 0; i < sg.g.size(); i++) {
+            EXPECT_EQ(sg.get_fin(i, 0), 0.);
+            EXPECT_EQ(sg.get_fin(i, 1), 0.);
+        }
 }
 
 TEST_F(SegmentTest, SetBulkFin)
 {
     Segment sg {Config::segmass, Config::cl, conf.ei0, msgr};
     const szt a = 2;
-    sg.set_bulk_fin(a);
+    EXPECT_EQ(sg.set_bulk_fin(a), 1.);
 
-    EXPECT_EQ(sg.g[0].get_fin(0), 0.);
+    if constexpr (!mitosim::heterogeneous_fission) return;
+    EXPECT_EQ(sg.get_fin(0, 0), 0.);
     for (szt i = 0; i < sg.g.size()-1; i++) {
         if (i == a) {
-            EXPECT_EQ(sg.g[i].get_fin(1), 1.);
-            EXPECT_EQ(sg.g[i+1].get_fin(0), 1.);
+            EXPECT_EQ(sg.get_fin(i, 1), 1.);
+            EXPECT_EQ(sg.get_fin(i+1, 0), 1.);
         }
         else {
-            EXPECT_EQ(sg.g[i].get_fin(1), 0.);
-            EXPECT_EQ(sg.g[i+1].get_fin(0), 0.);
+            EXPECT_EQ(sg.get_fin(i, 1), 0.);
+            EXPECT_EQ(sg.get_fin(i+1, 0), 0.);
+        }
+    }
+    EXPECT_EQ(sg.get_fin(sg.g.size()-1, 1), 0.);
+}
+
+TEST_F(SegmentTest, SetFins)
+{
+    Segment sg {Config::segmass, Config::cl, conf.ei0, msgr};
+    sg.nn[2] = 1;
+    sg.reflect_g();
+
+    // Bulk nodes count twice, the connected end 2 once, the free end 1 not.
+    EXPECT_EQ(sg.set_fins(), 2. * (Config::segmass - 1) + 1.);
+    EXPECT_EQ(sg.get_fin(0, 0), 0.);
+    EXPECT_EQ(sg.get_fin(sg.g.size()-1, 1), 1.);
+    if constexpr (mitosim::heterogeneous_fission) {
+        ASSERT_EQ(sg.fin[0].size(), sg.g.size());
+    }
+
+    // The factors follow their edges when the storage is reversed.
+    sg.orient();
+    EXPECT_EQ(sg.get_fin(0, 0), 0.);
+    EXPECT_EQ(sg.get_fin(sg.g.size()-1, 1), 1.);
+    if constexpr (mitosim::heterogeneous_fission) {
+        EXPECT_EQ(sg.fin[0][0], 0.);
+    }
+}
+
+TEST_F(SegmentTest, WriteRead)
+{
+    Segment sg1 {Config::segmass, Config::cl, conf.ei0, msgr};
+    sg1.nn[2] = 2;
+    sg1.neig[2][1] = 5; sg1.neen[2][1] = 1;
+    sg1.neig[2][2] = 7; sg1.neen[2][2] = 2;
+    sg1.set_fins();
+    sg1.reflect_g();
+    Segment sg2 {Config::segmass + 1, Config::cl + 1, conf.ei0 + 10, msgr};
+    sg2.nn[1] = 1;
+    sg2.neig[1][1] = 3; sg2.neen[1][1] = 2;
+    sg2.set_fins();
+
+    const auto file = std::filesystem::temp_directory_path()
+                    / "mitosim_segment_test.bin";
+    {
+        std::ofstream ofs {file, std::ios::binary};
+        sg1.write(ofs, 0);
+        sg2.write(ofs, sg1.length());
+    }
+
+    // The second segment is read correctly only if the first one
+    // consumed all it has written.
+    std::ifstream ifs {file, std::ios::binary};
+    for (const auto* sg : {&sg1, &sg2}) {
+        Segment rd {msgr};
+        rd.read(ifs);
+        ASSERT_TRUE(ifs.good());
+        ASSERT_EQ(rd.length(), sg->length());
+        EXPECT_EQ(rd.get_cl(), sg->get_cl());
+        for (szt e = 1; e <= 2; e++) {
+            ASSERT_EQ(rd.nn[e], sg->nn[e]);
+            for (szt j = 1; j <= rd.nn[e]; j++) {
+                EXPECT_EQ(rd.neig[e][j], sg->neig[e][j]);
+                EXPECT_EQ(rd.neen[e][j], sg->neen[e][j]);
+            }
+        }
+        for (szt a = 0; a < rd.length(); a++) {
+            EXPECT_EQ(rd.edge(a).get_ind(), sg->edge(a).get_ind());
+            EXPECT_EQ(rd.get_fin(a, 0), sg->get_fin(a, 0));
+            EXPECT_EQ(rd.get_fin(a, 1), sg->get_fin(a, 1));
         }
     }
-    EXPECT_EQ(sg.g.back().get_fin(1), 0.);
+    EXPECT_EQ(ifs.peek(), std::ifstream::traits_type::eof());
+    ifs.close();
+    std::filesystem::remove(file);
 }
 
 }  // namespace segment_test
@@ -0,0 +1,58 @@
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "../slot_map.h"
+
+namespace slot_map_test {
+
+using szt = mitosim::szt;
+using SlotMap = mitosim::SlotMap<std::uint32_t>;
+
+TEST(SlotMapTest, FollowsSwapRemove)
+{
+    // Mirrors a 1-based dense array in which the last element
+    // takes the place of a removed one.
+    SlotMap m;
+    std::vector<SlotMap::Handle> h {{}};
+    for (szt d=1; d<=5; d++)
+        h.push_back(m.insert(d));
+    EXPECT_EQ(m.size(), 5);
+    for (szt d=1; d<=5; d++)
+        EXPECT_EQ(m.index(h[d]), d);
+
+    m.erase(2);
+    m.move(5, 2);
+    EXPECT_EQ(m.size(), 4);
+    EXPECT_FALSE(m.contains(h[2]));
+    EXPECT_EQ(m.index(h[5]), 2);
+    EXPECT_EQ(m.handle(2), h[5]);
+    EXPECT_EQ(m.index(h[1]), 1);
+    EXPECT_EQ(m.index(h[3]), 3);
+    EXPECT_EQ(m.index(h[4]), 4);
+
+    // Removal of the last element needs no move.
+    m.erase(4);
+    EXPECT_FALSE(m.contains(h[4]));
+    EXPECT_EQ(m.size(), 3);
+}
+
+TEST(SlotMapTest, ReusesSlots)
+{
+    SlotMap m;
+    const auto h1 = m.insert(1);
+    const auto h2 = m.insert(2);
+    m.erase(2);
+
+    // The freed slot is reissued under a new generation.
+    const auto h3 = m.insert(2);
+    EXPECT_EQ(h3.slot, h2.slot);
+    EXPECT_NE(h3, h2);
+    EXPECT_FALSE(m.contains(h2));
+    EXPECT_EQ(m.index(h3), 2);
+    EXPECT_EQ(m.index(h1), 1);
+    EXPECT_FALSE(m.contains(SlotMap::Handle {}));
+}
+
+}  // namespace slot_map_test
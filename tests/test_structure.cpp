@@ -53,15 +53,20 @@ TEST_F(StructureTest, AddDisconnectedSegment)
     Structure s {msgr};
     s.add_disconnected_segment(len);
 
-    ASSERT_TRUE(s.glm.empty());
-    ASSERT_TRUE(s.gla.empty());
+    ASSERT_EQ(s.glm.size(), len);
+    ASSERT_EQ(s.gla.size(), len);
+    for (szt j=0; j<len; j++) {
+        EXPECT_EQ(s.glm[j], 1);
+        EXPECT_EQ(s.gla[j], j);
+    }
     for (const auto& n : s.nn)
         EXPECT_EQ(n, 0);
     EXPECT_EQ(s.mtnum, 1);
     EXPECT_EQ(s.clnum, 1);
     EXPECT_EQ(s.mtmass, len);
     EXPECT_EQ(s.mt.size(), s.mtnum + 1);
-    ASSERT_TRUE(s.clmt.empty());
+    ASSERT_EQ(s.clmt.size(), s.clnum);
+    EXPECT_EQ(s.clmt[0], std::vector<mitosim::Index> {1});
     ASSERT_TRUE(s.mt11.empty());
     ASSERT_TRUE(s.mtc11.empty());
     ASSERT_TRUE(s.mt22.empty());
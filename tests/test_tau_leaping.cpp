@@ -0,0 +1,154 @@
+#include <array>
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "utils/stochastic/reaction.h"
+
+#include "../definitions.h"
+#include "../tau_leaping.h"
+
+namespace tau_leaping_test {
+
+using szt = mitosim::szt;
+using RandFactory = mitosim::RandFactory;
+using Reaction = utils::stochastic::Reaction<RandFactory>;
+using Engine = mitosim::TauLeaping<RandFactory, Reaction>;
+using Reactions = mitosim::vup<Reaction>;
+
+// Conversion of the reactants of a pool into those of another one:
+// the score is proportional to the reactant number.
+class Conversion
+    : public Reaction {
+
+public:
+
+    Conversion(mitosim::Msgr& msgr, szt ind, double rate,
+               szt& from, szt& to)
+        : Reaction {msgr, ind, rate, "cv" + std::to_string(ind), "conversion"}
+        , from {from}
+        , to {to}
+    {}
+
+    szt& from;
+    szt& to;
+
+    void set_score() noexcept override { *score = rate * from; }
+    void update_prop(szt, szt) noexcept override {}
+    void set_prop() noexcept override {}
+    void update_netw_stats() override
+    {
+        for (auto& o : dependents)
+            o->set_score();
+    }
+    void initialize_dependencies(const Reactions& rc) noexcept override
+    {
+        for (const auto& o : rc)
+            dependents.push_back(o.get());
+        set_score();
+    }
+    void fire() noexcept override
+    {
+        eventCount++;
+        from--;
+        to++;
+        update_netw_stats();
+    }
+};
+
+// Conversion applied in batches: the events run out with the reactants,
+// and the score is refreshed at the leap end only.
+class BatchedConversion
+    : public Conversion
+    , public mitosim::BatchedReaction {
+
+public:
+
+    using Conversion::Conversion;
+
+    szt queued {};  // events drawn and not applied yet
+
+    void draw_event() override { queued++; }
+    bool apply_event() override
+    {
+        queued--;
+        if (!from)
+            return false;
+        eventCount++;
+        from--;
+        to++;
+        return true;
+    }
+    void settle() override { set_score(); }
+};
+
+class TauLeapingTest
+    : public testing::Test {
+
+protected:
+
+    mitosim::Msgr msgr;
+    RandFactory rnd {7, msgr};
+
+    std::array<szt,2> n {};
+
+    /**
+     * @brief Runs the reversible conversion A <-> B until a given time.
+     * @tparam R Type of the conversion.
+     * @param e The engine.
+     * @param t Time to stop at.
+     */
+    template<typename R=Conversion>
+    void run(Engine& e, const double t)
+    {
+        e.add_reaction(std::make_unique<R>(msgr, 0, 1., n[0], n[1]),
+                       [this] { return n[0]; });
+        e.add_reaction(std::make_unique<R>(msgr, 1, 3., n[1], n[0]),
+                       [this] { return n[1]; });
+        e.initialize();
+
+        double time {};
+        while (time < t && e.set_asum())
+            e.fire(time);
+    }
+};
+
+TEST_F(TauLeapingTest, Equilibrium)
+{
+    // The leaps reproduce the equilibrium of the reversible conversion.
+    n = {100'000, 0};
+    Engine e {rnd};
+    run(e, 5.);
+
+    EXPECT_EQ(n[0] + n[1], 100'000);
+    EXPECT_NEAR(n[0], 75'000., 750.);
+    EXPECT_GT(e.get_leaps(), 0);
+}
+
+TEST_F(TauLeapingTest, Batches)
+{
+    // The batched leaps reproduce the equilibrium, with the scores
+    // refreshed once per leap.
+    n = {100'000, 0};
+    Engine e {rnd};
+    run<BatchedConversion>(e, 5.);
+
+    EXPECT_EQ(n[0] + n[1], 100'000);
+    EXPECT_NEAR(n[0], 75'000., 750.);
+    EXPECT_GT(e.get_leaps(), 0);
+    EXPECT_EQ(e.get_postponed(), 0);
+}
+
+TEST_F(TauLeapingTest, ExactFallback)
+{
+    // Small reactant numbers are handled by exact steps only.
+    n = {20, 0};
+    Engine e {rnd};
+    run(e, 5.);
+
+    EXPECT_EQ(n[0] + n[1], 20);
+    EXPECT_EQ(e.get_leaps(), 0);
+}
+
+}  // namespace tau_leaping_test